@@ -0,0 +1,24 @@
+#-------------------------------------------------
+#
+# FlySight Viewer benchmarks
+#
+#-------------------------------------------------
+
+TARGET = FlySightBenchmark
+TEMPLATE = app
+
+CONFIG   += console
+CONFIG   -= app_bundle
+
+include(../src/FlySightViewer.pri)
+
+INCLUDEPATH += ../src
+
+SOURCES += main.cpp \
+    trackgenerator.cpp
+
+HEADERS  += trackgenerator.h
+
+win32 {
+    LIBS += -lpsapi
+}
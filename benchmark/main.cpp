@@ -0,0 +1,848 @@
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QMap>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QVector>
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "atmosphere.h"
+#include "dataplot.h"
+#include "datapoint.h"
+#include "mainwindow.h"
+#include "scoringmethod.h"
+#include "trackcatalog.h"
+#include "trackgenerator.h"
+#include "trackimporter.h"
+#include "trackkernel.h"
+#include "trackparser.h"
+#include "trackprocessor.h"
+#include "trackstore.h"
+
+// Times each stage of importing and displaying a track. Tracks are either
+// read from a file or generated, so that runs can be compared between
+// versions. Each stage is run several times and the best time is reported,
+// along with the peak memory use of the process so far.
+
+// Reference implementation of the original QTextStream import path
+static bool legacyImport(
+        const QString &fileName,
+        QVector< DataPoint > &data)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    QTextStream in(&file);
+
+    // Column enumeration
+    typedef enum {
+        Time = 0,
+        Lat,
+        Lon,
+        HMSL,
+        VelN,
+        VelE,
+        VelD,
+        HAcc,
+        VAcc,
+        SAcc,
+        NumSV
+    } Columns;
+
+    // Read column labels
+    QMap< int, int > colMap;
+    if (!in.atEnd())
+    {
+        QString line = in.readLine();
+        QStringList cols = line.split(",");
+
+        for (int i = 0; i < cols.size(); ++i)
+        {
+            const QString &s = cols[i];
+
+            if (s == "time")    colMap[Time]    = i;
+            if (s == "lat")     colMap[Lat]     = i;
+            if (s == "lon")     colMap[Lon]     = i;
+            if (s == "hMSL")    colMap[HMSL]    = i;
+            if (s == "velN")    colMap[VelN]    = i;
+            if (s == "velE")    colMap[VelE]    = i;
+            if (s == "velD")    colMap[VelD]    = i;
+            if (s == "hAcc")    colMap[HAcc]    = i;
+            if (s == "vAcc")    colMap[VAcc]    = i;
+            if (s == "sAcc")    colMap[SAcc]    = i;
+            if (s == "numSV")   colMap[NumSV]   = i;
+        }
+    }
+
+    // Skip next row
+    if (!in.atEnd()) in.readLine();
+
+    data.clear();
+
+    while (!in.atEnd())
+    {
+        QString line = in.readLine();
+        QStringList cols = line.split(",");
+
+        DataPoint pt;
+
+        pt.timestamp = QDateTime::fromString(cols[colMap[Time]], Qt::ISODate)
+                .toMSecsSinceEpoch();
+
+        pt.hasGeodetic = true;
+
+        pt.lat   = cols[colMap[Lat]].toDouble();
+        pt.lon   = cols[colMap[Lon]].toDouble();
+        pt.hMSL  = cols[colMap[HMSL]].toDouble();
+
+        pt.velN  = cols[colMap[VelN]].toDouble();
+        pt.velE  = cols[colMap[VelE]].toDouble();
+        pt.velD  = cols[colMap[VelD]].toDouble();
+
+        pt.hAcc  = cols[colMap[HAcc]].toDouble();
+        pt.vAcc  = cols[colMap[VAcc]].toDouble();
+        pt.sAcc  = cols[colMap[SAcc]].toDouble();
+
+        pt.numSV = cols[colMap[NumSV]].toDouble();
+
+        data.append(pt);
+    }
+
+    return true;
+}
+
+static bool parserImport(
+        const QString &fileName,
+        QVector< DataPoint > &data)
+{
+    TrackParser parser;
+    if (!parser.open(fileName))
+    {
+        return false;
+    }
+
+    data.clear();
+    parser.readRows(data);
+
+    return true;
+}
+
+static bool sameRow(
+        const DataPoint &a,
+        const DataPoint &b)
+{
+    return a.timestamp == b.timestamp
+            && a.lat == b.lat && a.lon == b.lon && a.hMSL == b.hMSL
+            && a.velN == b.velN && a.velE == b.velE && a.velD == b.velD
+            && a.hAcc == b.hAcc && a.vAcc == b.vAcc && a.sAcc == b.sAcc
+            && a.numSV == b.numSV;
+}
+
+// Every value of every row is bitwise equal
+static bool sameValues(
+        const QVector< DataPoint > &a,
+        const QVector< DataPoint > &b)
+{
+    if (a.size() != b.size()) return false;
+
+    const TrackStore trackA(a), trackB(b);
+
+    for (int c = 0; c < TrackStore::Timestamp; ++c)
+    {
+        const TrackStore::Column column = (TrackStore::Column) c;
+        if (memcmp(trackA.column(column).data(), trackB.column(column).data(),
+                   trackA.size() * sizeof(double)) != 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static double peakMemory()
+{
+    // Peak resident size in MB
+#if defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return counters.PeakWorkingSetSize / (1024.0 * 1024.0);
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(Q_OS_MAC)
+    return usage.ru_maxrss / (1024.0 * 1024.0);
+#else
+    return usage.ru_maxrss / 1024.0;
+#endif
+#endif
+}
+
+static void keepBest(
+        double &best,
+        const QElapsedTimer &timer)
+{
+    const double ms = timer.nsecsElapsed() / 1e6;
+    if (best < 0 || ms < best) best = ms;
+}
+
+static void report(
+        const char *stage,
+        int rows,
+        double ms)
+{
+    printf("%-20s %10d %12.2f %10.1f\n", stage, rows, ms, peakMemory());
+    fflush(stdout);
+}
+
+static void clearCache()
+{
+    // Cache is in a test location, so it's safe to remove
+    QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+         + "/tracks").removeRecursively();
+}
+
+int main(int argc, char *argv[])
+{
+    // Plots are drawn without a display unless asked otherwise
+    if (qgetenv("QT_QPA_PLATFORM").isEmpty())
+    {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QApplication app(argc, argv);
+    app.setApplicationName("FlySightBenchmark");
+
+    // Keep caches and settings away from the viewer's
+    QStandardPaths::setTestModeEnabled(true);
+
+    QTemporaryDir tempDir;
+    QSettings::setPath(QSettings::NativeFormat, QSettings::UserScope, tempDir.path());
+    QSettings::setPath(QSettings::IniFormat, QSettings::UserScope, tempDir.path());
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Times import and processing of FlySight tracks.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("file", "Track to read instead of a generated one.");
+
+    QCommandLineOption rateOption("rate", "Sample rate of generated track (5-100 Hz).", "hz", "5");
+    QCommandLineOption durationOption("duration", "Duration of generated track (minutes).", "minutes", "15");
+    QCommandLineOption profileOption("profile", "Generated flight: skydive, wingsuit or ground.", "profile", "skydive");
+    QCommandLineOption seedOption("seed", "Random seed of generated track.", "seed", "1");
+    QCommandLineOption outputOption("output", "Keep generated track in this file.", "file");
+    QCommandLineOption runsOption("runs", "Runs per stage.", "runs", "5");
+    QCommandLineOption windowOption("slope-window", "Window used for slopes (seconds).", "seconds", "1");
+    QCommandLineOption legacyOption("legacy", "Also time the original QTextStream import.");
+    QCommandLineOption noOptimizeOption("no-optimize", "Skip the optimizer stage.");
+
+    parser.addOption(rateOption);
+    parser.addOption(durationOption);
+    parser.addOption(profileOption);
+    parser.addOption(seedOption);
+    parser.addOption(outputOption);
+    parser.addOption(runsOption);
+    parser.addOption(windowOption);
+    parser.addOption(legacyOption);
+    parser.addOption(noOptimizeOption);
+
+    parser.process(app);
+
+    const int runs = qMax(1, parser.value(runsOption).toInt());
+    QString fileName;
+    qint64 exitTime = -1;
+
+    printf("%-20s %10s %12s %10s\n", "stage", "rows", "best ms", "peak MB");
+
+    if (!parser.positionalArguments().isEmpty())
+    {
+        fileName = parser.positionalArguments().first();
+    }
+    else
+    {
+        // Generate track
+        TrackGenerator generator;
+        TrackGenerator::Profile profile;
+
+        if (!TrackGenerator::profileFromString(parser.value(profileOption), profile))
+        {
+            fprintf(stderr, "Unknown profile\n");
+            return 1;
+        }
+
+        generator.setSampleRate(parser.value(rateOption).toDouble());
+        generator.setDuration(parser.value(durationOption).toDouble() * 60);
+        generator.setProfile(profile);
+        generator.setSeed(parser.value(seedOption).toUInt());
+
+        fileName = parser.isSet(outputOption) ? parser.value(outputOption)
+                                              : tempDir.path() + "/track.csv";
+
+        QElapsedTimer timer;
+        timer.start();
+
+        if (!generator.write(fileName))
+        {
+            fprintf(stderr, "Can't write %s\n", qPrintable(fileName));
+            return 1;
+        }
+
+        report("generate", generator.rows(), timer.nsecsElapsed() / 1e6);
+        exitTime = generator.exitTime();
+    }
+
+    // Parse only
+    QVector< DataPoint > data;
+    double best = -1;
+
+    for (int i = 0; i < runs; ++i)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        parserImport(fileName, data);
+        keepBest(best, timer);
+    }
+
+    if (data.isEmpty())
+    {
+        fprintf(stderr, "No rows in %s\n", qPrintable(fileName));
+        return 1;
+    }
+
+    report("parse", data.size(), best);
+
+    // Assume exit is at the highest point of a track read from a file
+    if (exitTime < 0)
+    {
+        int exit = 0;
+        for (int i = 1; i < data.size(); ++i)
+        {
+            if (data[i].hMSL > data[exit].hMSL) exit = i;
+        }
+
+        exitTime = data[exit].timestamp;
+    }
+
+    if (parser.isSet(legacyOption))
+    {
+        QVector< DataPoint > legacy;
+        best = -1;
+
+        for (int i = 0; i < runs; ++i)
+        {
+            QElapsedTimer timer;
+            timer.start();
+
+            legacyImport(fileName, legacy);
+            keepBest(best, timer);
+        }
+
+        report("parse (QTextStream)", legacy.size(), best);
+
+        // Check that both paths produce the same rows
+        bool same = (legacy.size() == data.size());
+        for (int i = 0; same && i < data.size(); ++i)
+        {
+            same = sameRow(legacy[i], data[i]);
+        }
+
+        if (!same)
+        {
+            printf("FAILED: rows differ from QTextStream import\n");
+            return 1;
+        }
+    }
+
+    // Settings as used by the viewer by default
+    TrackProcessor processor;
+    processor.setReference(data.last(), true);
+    processor.setSlopeWindow(parser.value(windowOption).toDouble());
+
+    // Complete import, as run by MainWindow::importFile
+    TrackImporter importer;
+    importer.setActive(1);
+    best = -1;
+
+    for (int i = 0; i < runs; ++i)
+    {
+        clearCache();
+
+        QElapsedTimer timer;
+        timer.start();
+
+        importer.importFile(1, fileName, processor, true);
+        keepBest(best, timer);
+    }
+
+    report("importFile", data.size(), best);
+
+    best = -1;
+    for (int i = 0; i < runs; ++i)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        importer.importFile(1, fileName, processor, true);
+        keepBest(best, timer);
+    }
+
+    report("importFile (cached)", data.size(), best);
+    clearCache();
+
+    // Derived values, as recomputed by MainWindow
+    processor.processAll(data);
+
+    best = -1;
+    for (int i = 0; i < runs; ++i)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        processor.initAltitude(data, 0, data.size());
+        keepBest(best, timer);
+    }
+
+    report("initAltitude", data.size(), best);
+
+    best = -1;
+    for (int i = 0; i < runs; ++i)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        processor.updatePosition(data, 0, data.size());
+        processor.updateSlopes(data, 0, data.size());
+        keepBest(best, timer);
+    }
+
+    report("updateVelocity", data.size(), best);
+
+    // Slopes at 100 Hz, where each window holds the most rows
+    {
+        TrackGenerator generator;
+        TrackGenerator::Profile profile;
+
+        if (!TrackGenerator::profileFromString(parser.value(profileOption), profile))
+        {
+            profile = TrackGenerator::Skydive;
+        }
+
+        generator.setSampleRate(100);
+        generator.setDuration(parser.value(durationOption).toDouble() * 60);
+        generator.setProfile(profile);
+        generator.setSeed(parser.value(seedOption).toUInt());
+
+        const QString fastName = tempDir.path() + "/track100.csv";
+        QVector< DataPoint > fast;
+
+        if (generator.write(fastName) && parserImport(fastName, fast) && !fast.isEmpty())
+        {
+            TrackProcessor fastProcessor = processor;
+            fastProcessor.setReference(fast.last(), true);
+            fastProcessor.processAll(fast);
+
+            best = -1;
+            for (int i = 0; i < runs; ++i)
+            {
+                QElapsedTimer timer;
+                timer.start();
+
+                fastProcessor.updateSlopes(fast, 0, fast.size());
+                keepBest(best, timer);
+            }
+
+            report("updateSlopes (100 Hz)", fast.size(), best);
+        }
+
+        QFile::remove(fastName);
+    }
+
+    // Geodesic reference for the tangent plane projection
+    TrackProcessor exactProcessor = processor;
+    exactProcessor.setExactGeodesic(true);
+
+    QVector< DataPoint > exact = data;
+
+    best = -1;
+    for (int i = 0; i < runs; ++i)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        exactProcessor.updatePosition(exact, 0, exact.size());
+        exactProcessor.updateSlopes(exact, 0, exact.size());
+        keepBest(best, timer);
+    }
+
+    report("updateVelocity (geo)", exact.size(), best);
+
+    double projectionError = 0;
+    for (int i = 0; i < data.size(); ++i)
+    {
+        const double dx = data[i].x - exact[i].x;
+        const double dy = data[i].y - exact[i].y;
+        projectionError = qMax(projectionError, sqrt(dx * dx + dy * dy));
+    }
+
+    printf("%-20s %10s %12.4f m\n", "projection error", "", projectionError);
+    exact.clear();
+
+    best = -1;
+    for (int i = 0; i < runs; ++i)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        processor.initAerodynamics(data, 0, data.size());
+        keepBest(best, timer);
+    }
+
+    report("initAerodynamics", data.size(), best);
+
+    // Air density for every row, from the exact formula and the polynomial
+    QVector< double > altitudes(data.size()), densities(data.size());
+    for (int i = 0; i < data.size(); ++i)
+    {
+        altitudes[i] = data[i].hMSL;
+    }
+
+    best = -1;
+    for (int i = 0; i < runs; ++i)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        for (int j = 0; j < altitudes.size(); ++j)
+        {
+            densities[j] = Atmosphere::exactDensity(altitudes[j]);
+        }
+        keepBest(best, timer);
+    }
+
+    report("density (exact)", altitudes.size(), best);
+
+    best = -1;
+    for (int i = 0; i < runs; ++i)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        Atmosphere::density(altitudes.constData(), densities.data(), densities.size());
+        keepBest(best, timer);
+    }
+
+    report("density (batch)", densities.size(), best);
+
+    // Largest relative error of the polynomial over its whole range
+    double densityError = 0;
+    for (double h = Atmosphere::MinAltitude; h <= Atmosphere::MaxAltitude; h += 0.25)
+    {
+        const double exact = Atmosphere::exactDensity(h);
+        densityError = qMax(densityError, fabs(Atmosphere::density(h) - exact) / exact);
+    }
+
+    printf("%-20s %10s %12.2e %s\n", "density error", "", densityError,
+           densityError <= Atmosphere::MaxError ? "ok" : "FAILED");
+
+    if (densityError > Atmosphere::MaxError)
+    {
+        return 1;
+    }
+
+    // Settings changes, recomputing only the affected columns
+    TrackProcessor windProcessor = processor;
+    windProcessor.setWind(true, 3, -2);
+
+    TrackProcessor massProcessor = processor;
+    massProcessor.setAerodynamics(processor.mass() + 10, processor.planformArea());
+
+    best = -1;
+    for (int i = 0; i < runs; ++i)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        windProcessor.update(data, processor);
+        keepBest(best, timer);
+
+        processor.update(data, windProcessor);
+    }
+
+    report("update (wind)", data.size(), best);
+
+    best = -1;
+    for (int i = 0; i < runs; ++i)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        massProcessor.update(data, processor);
+        keepBest(best, timer);
+
+        processor.update(data, massProcessor);
+    }
+
+    report("update (mass)", data.size(), best);
+
+    // Whole track serially and split across all cores
+    TrackProcessor parallelProcessor = processor;
+    parallelProcessor.setParallel(true);
+
+    QVector< DataPoint > serialData = data, parallelData = data;
+
+    best = -1;
+    for (int i = 0; i < runs; ++i)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        processor.processAll(serialData);
+        keepBest(best, timer);
+    }
+
+    report("processAll", serialData.size(), best);
+
+    best = -1;
+    for (int i = 0; i < runs; ++i)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        parallelProcessor.processAll(parallelData);
+        keepBest(best, timer);
+    }
+
+    report("processAll (threads)", parallelData.size(), best);
+
+    // Every value in one pass over the rows, as they are imported
+    QVector< DataPoint > fusedData;
+
+    best = -1;
+    for (int i = 0; i < runs; ++i)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        fusedData.clear();
+        fusedData.reserve(data.size());
+
+        TrackKernel kernel(processor);
+        for (int j = 0; j < data.size(); ++j)
+        {
+            kernel.addRow(data[j], fusedData);
+        }
+
+        kernel.finish(fusedData);
+        keepBest(best, timer);
+    }
+
+    report("processAll (fused)", fusedData.size(), best);
+
+    // In columns, a block of rows at a time
+    TrackStore blockTrack(data);
+
+    best = -1;
+    for (int i = 0; i < runs; ++i)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        parallelProcessor.processAll(blockTrack);
+        keepBest(best, timer);
+    }
+
+    report("processAll (blocks)", blockTrack.size(), best);
+
+    // All must give exactly the same values
+    const bool parallelIdentical = sameValues(serialData, parallelData);
+    const bool fusedIdentical = sameValues(serialData, fusedData);
+    const bool blocksIdentical = sameValues(serialData, blockTrack.rawRows());
+
+    printf("%-20s %10s %12s %s\n", "threads result", "", "",
+           parallelIdentical ? "identical" : "DIFFERENT");
+    printf("%-20s %10s %12s %s\n", "fused result", "", "",
+           fusedIdentical ? "identical" : "DIFFERENT");
+    printf("%-20s %10s %12s %s\n", "blocks result", "", "",
+           blocksIdentical ? "identical" : "DIFFERENT");
+
+    if (!parallelIdentical || !fusedIdentical || !blocksIdentical)
+    {
+        return 1;
+    }
+
+    // Range of one value, reading rows or a single column. Cache lines are
+    // those the loop has to load, which dominate its time on long tracks.
+    const TrackStore track(data);
+    double zMin = 0, zMax = 0;
+
+    best = -1;
+    for (int i = 0; i < runs; ++i)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        zMin = zMax = data[0].z;
+        for (int j = 1; j < data.size(); ++j)
+        {
+            zMin = qMin(zMin, data[j].z);
+            zMax = qMax(zMax, data[j].z);
+        }
+        keepBest(best, timer);
+    }
+
+    report("scan (rows)", data.size(), best);
+    printf("%-20s %10s %12.0f lines\n", "cache lines", "",
+           ceil(data.size() * (double) sizeof(DataPoint) / 64));
+
+    best = -1;
+    for (int i = 0; i < runs; ++i)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        const TrackStore::Span z = track.column(TrackStore::Z);
+        zMin = zMax = z[0];
+        for (int j = 1; j < z.size(); ++j)
+        {
+            zMin = qMin(zMin, z[j]);
+            zMax = qMax(zMax, z[j]);
+        }
+        keepBest(best, timer);
+    }
+
+    report("scan (columns)", track.size(), best);
+    printf("%-20s %10s %12.0f lines\n", "cache lines", "",
+           ceil(track.size() * (double) sizeof(double) / 64));
+    printf("%-20s %10s %12.1f m\n", "elevation range", "", zMax - zMin);
+
+    // Same rows in compact storage
+    TrackStore compact;
+
+    best = -1;
+    for (int i = 0; i < runs; ++i)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        compact = TrackStore(data, true);
+        keepBest(best, timer);
+    }
+
+    report("store (compact)", compact.size(), best);
+    printf("%-20s %10s %12d bytes (full %d)\n", "row size", "",
+           compact.rowBytes(), track.rowBytes());
+
+    best = -1;
+    for (int i = 0; i < runs; ++i)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        const TrackStore::Span z = compact.column(TrackStore::Z);
+        zMin = zMax = z[0];
+        for (int j = 1; j < z.size(); ++j)
+        {
+            zMin = qMin(zMin, z[j]);
+            zMax = qMax(zMax, z[j]);
+        }
+        keepBest(best, timer);
+    }
+
+    report("scan (compact)", compact.size(), best);
+    printf("%-20s %10s %12.1f m\n", "elevation range", "", zMax - zMin);
+
+    // Time lookups spread over the track, as made by cursors and scoring
+    const int lookups = 1000000;
+    const double tFirst = track.value(0, TrackStore::T);
+    const double tLast = track.value(track.size() - 1, TrackStore::T);
+    int below = 0, above = 0;
+    double fraction = 0, checksum = 0;
+
+    best = -1;
+    for (int i = 0; i < runs; ++i)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        checksum = 0;
+        for (int j = 0; j < lookups; ++j)
+        {
+            const double t = tFirst + (tLast - tFirst) * (j % 9973) / 9973;
+            track.bracketT(t, below, above, fraction);
+            checksum += below + fraction;
+        }
+        keepBest(best, timer);
+    }
+
+    report("bracketT", lookups, best);
+    printf("%-20s %10s %12.0f\n", "checksum", "", checksum);
+
+    // Show the track in a main window
+    MainWindow window;
+    window.resize(1280, 800);
+    window.show();
+
+    window.trackCatalog()->insert(fileName, TrackStore(data), processor);
+    window.selectTrack(fileName);
+    app.processEvents();
+
+    // The window must keep the reference the track was processed with, or
+    // any change of settings recomputes times
+    const bool sameTime =
+            !(window.trackProcessor().changedColumns(processor) & TrackProcessor::Time);
+
+    printf("%-20s %10s %12s %s\n", "window reference", "", "",
+           sameTime ? "ok" : "FAILED");
+
+    if (!sameTime)
+    {
+        return 1;
+    }
+
+    best = -1;
+    for (int i = 0; i < runs; ++i)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        window.plotArea()->updatePlot();
+        keepBest(best, timer);
+    }
+
+    report("updatePlot", data.size(), best);
+
+    // Optimize from exit, which takes a fixed amount of work
+    if (!parser.isSet(noOptimizeOption) && exitTime >= 0)
+    {
+        window.setZero((exitTime - data.last().timestamp) / 1000.0);
+
+        QElapsedTimer timer;
+        timer.start();
+
+        window.scoringMethod(MainWindow::PPC)->optimize();
+
+        report("optimize", window.optimalSize(), timer.nsecsElapsed() / 1e6);
+    }
+
+    return 0;
+}
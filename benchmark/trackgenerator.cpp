@@ -0,0 +1,233 @@
+#include <QByteArray>
+#include <QDateTime>
+#include <QFile>
+
+#include <math.h>
+#include <stdio.h>
+
+#include "trackgenerator.h"
+
+// Flight profile
+#define GROUND_ELEVATION  100     // m
+#define EXIT_ALTITUDE     4000    // m above ground
+#define DEPLOY_ALTITUDE   1000    // m above ground
+
+#define EARTH_RADIUS      6371000 // m
+
+#ifndef PI
+#define PI                3.14159265358979323846
+#endif
+
+TrackGenerator::TrackGenerator():
+    mSampleRate(5),
+    mDuration(900),
+    mProfile(Skydive),
+    mSeed(1),
+    mState(1),
+    mRows(0),
+    mExitTime(-1)
+{
+
+}
+
+void TrackGenerator::setSampleRate(
+        double rate)
+{
+    mSampleRate = qBound(5.0, rate, 100.0);
+}
+
+void TrackGenerator::setDuration(
+        double duration)
+{
+    mDuration = qBound(1.0, duration, 86400.0);
+}
+
+void TrackGenerator::setProfile(
+        Profile profile)
+{
+    mProfile = profile;
+}
+
+void TrackGenerator::setSeed(
+        quint32 seed)
+{
+    mSeed = seed ? seed : 1;
+}
+
+bool TrackGenerator::profileFromString(
+        const QString &name,
+        Profile &profile)
+{
+    if (name == "skydive")       profile = Skydive;
+    else if (name == "wingsuit") profile = Wingsuit;
+    else if (name == "ground")   profile = Ground;
+    else return false;
+
+    return true;
+}
+
+double TrackGenerator::uniform()
+{
+    // xorshift32
+    mState ^= mState << 13;
+    mState ^= mState >> 17;
+    mState ^= mState << 5;
+
+    return mState / 4294967296.0;
+}
+
+double TrackGenerator::noise(
+        double sigma)
+{
+    // Approximately normal
+    const double sum = uniform() + uniform() + uniform() + uniform();
+    return (sum - 2) * sigma * sqrt(3.0);
+}
+
+bool TrackGenerator::write(
+        const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        return false;
+    }
+
+    mState = mSeed;
+    mRows = 0;
+    mExitTime = -1;
+
+    const qint64 startTime = QDateTime(QDate(2016, 6, 1), QTime(12, 0), Qt::UTC)
+            .toMSecsSinceEpoch();
+    const int count = (int) (mDuration * mSampleRate) + 1;
+    const double dt = 1 / mSampleRate;
+
+    // True state
+    double lat = 47.0, lon = 8.0, hMSL = GROUND_ELEVATION;
+    double speed = 0, heading = 0, velD = 0;
+
+    Phase phase = (mProfile == Ground) ? Landed : Climb;
+
+    QByteArray buffer;
+    buffer.append("time,lat,lon,hMSL,velN,velE,velD,hAcc,vAcc,sAcc,heading,cAcc,gpsFix,numSV\n");
+    buffer.append(",(deg),(deg),(m),(m/s),(m/s),(m/s),(m),(m),(m/s),(deg),(deg),,\n");
+
+    qint64 day = -1;
+    QByteArray date;
+
+    for (int i = 0; i < count; ++i)
+    {
+        const double t = i * dt;
+        const qint64 ms = startTime + (qint64) floor(t * 1000 + 0.5);
+        const double agl = hMSL - GROUND_ELEVATION;
+
+        // Phase changes
+        if (phase == Climb && agl >= EXIT_ALTITUDE)
+        {
+            phase = Freefall;
+            mExitTime = ms;
+        }
+        if (phase == Freefall && agl <= DEPLOY_ALTITUDE)
+        {
+            phase = Canopy;
+        }
+        if (phase == Canopy && agl <= 0)
+        {
+            phase = Landed;
+            hMSL = GROUND_ELEVATION;
+        }
+
+        // Velocity for this phase
+        switch (phase)
+        {
+        case Climb:
+            speed = 40;
+            velD = -8;
+            heading += 1 * dt;
+            break;
+        case Freefall:
+            if (mProfile == Wingsuit)
+            {
+                speed += (45 - speed) * dt / 10;
+                velD += (18 - velD) * dt / 8;
+                heading += 10 * sin(t / 20) * dt;
+            }
+            else
+            {
+                speed *= exp(-dt / 5);
+                velD += 9.81 * (1 - velD * velD / (55 * 55)) * dt;
+            }
+            break;
+        case Canopy:
+            speed += (10 - speed) * dt / 3;
+            velD += (5 - velD) * dt / 3;
+            heading += 6 * dt;
+            break;
+        case Landed:
+            if (mProfile == Ground)
+            {
+                speed = 1.5;
+                heading += noise(20) * dt;
+            }
+            else
+            {
+                speed = 0;
+            }
+            velD = 0;
+            break;
+        }
+
+        const double velN = speed * cos(heading / 180 * PI);
+        const double velE = speed * sin(heading / 180 * PI);
+
+        // Measured values
+        const double mVelN = velN + noise(0.05);
+        const double mVelE = velE + noise(0.05);
+        const double mVelD = velD + noise(0.05);
+        const double mHMSL = hMSL + noise(0.3);
+
+        const double hAcc = 3 + 2 * uniform();
+        const double vAcc = 5 + 3 * uniform();
+        const double sAcc = 0.3 + 0.2 * uniform();
+        const int numSV = 10 + (int) (6 * uniform());
+
+        double course = atan2(mVelE, mVelN) / PI * 180;
+        if (course < 0) course += 360;
+
+        // Date changes at most once a day
+        if (ms / 86400000 != day)
+        {
+            day = ms / 86400000;
+            date = QDateTime::fromMSecsSinceEpoch(day * 86400000, Qt::UTC)
+                    .date().toString(Qt::ISODate).toLatin1();
+        }
+
+        const int msOfDay = (int) (ms - day * 86400000);
+
+        char row[256];
+        const int n = qsnprintf(row, sizeof(row),
+                "%sT%02d:%02d:%02d.%03dZ,%.7f,%.7f,%.3f,%.2f,%.2f,%.2f,%.3f,%.3f,%.2f,%.5f,%.5f,3,%d\n",
+                date.constData(),
+                msOfDay / 3600000, msOfDay / 60000 % 60, msOfDay / 1000 % 60, msOfDay % 1000,
+                lat, lon, mHMSL, mVelN, mVelE, mVelD,
+                hAcc, vAcc, sAcc, course, 0.5, numSV);
+        buffer.append(row, n);
+
+        if (buffer.size() >= (1 << 20))
+        {
+            file.write(buffer);
+            buffer.clear();
+        }
+
+        // Advance true state
+        lat += velN * dt / EARTH_RADIUS / PI * 180;
+        lon += velE * dt / (EARTH_RADIUS * cos(lat / 180 * PI)) / PI * 180;
+        hMSL -= velD * dt;
+
+        ++mRows;
+    }
+
+    file.write(buffer);
+
+    return true;
+}
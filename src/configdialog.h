@@ -52,6 +52,18 @@ public:
     void setSimulationTime(int simulationTime);
     int simulationTime() const;
 
+    void setResidentTracks(int residentTracks);
+    int residentTracks() const;
+
+    void setSlopeWindow(double window);
+    double slopeWindow() const;
+
+    void setExactGeodesic(bool exact);
+    bool exactGeodesic() const;
+
+    void setCompactStorage(bool compact);
+    bool compactStorage() const;
+
     QColor plotColor(int i) const;
 
     double plotMinimum(int i) const;
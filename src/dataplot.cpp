@@ -1,5 +1,8 @@
 #include <QToolTip>
 
+#include <algorithm>
+
+#include "common.h"
 #include "dataplot.h"
 #include "mainwindow.h"
 
@@ -7,7 +10,15 @@ DataPlot::DataPlot(QWidget *parent) :
     QCustomPlot(parent),
     mMainWindow(0),
     m_dragging(false),
-    m_xAxisType(Time)
+    m_xAxisType(Time),
+    mRevision(0),
+    mUnits(PlotValue::Metric),
+    mX(xaLast),
+    mY(yaLast),
+    mIntegrals(yaLast),
+    mOptimalRevision(0),
+    mOptimalX(xaLast),
+    mOptimalY(yaLast)
 {
     // Initialize window
     setMouseTracking(true);
@@ -145,7 +156,7 @@ void DataPlot::mouseReleaseEvent(
     if (m_dragging)
     {
         m_dragging = false;
-        replot();
+        update();
     }
 
     QCustomPlot::mouseReleaseEvent(event);
@@ -256,6 +267,37 @@ void DataPlot::paintEvent(
             painter.drawLine(axisRect()->rect().left(), m_cursorPos.y(), axisRect()->rect().right(), m_cursorPos.y());
         }
     }
+
+    // Draw mark
+    if (mMainWindow->markActive())
+    {
+        const DataPoint dpEnd = mMainWindow->markPoint();
+        const double x = xValue()->value(dpEnd, mMainWindow->units());
+
+        QPainter painter(this);
+
+        for (int j = 0; j < yaLast; ++j)
+        {
+            if (!yValue(j)->visible()) continue;
+
+            drawCursor(&painter, xAxis, yValue(j)->axis(),
+                       x, yValue(j)->value(dpEnd, mMainWindow->units()),
+                       mMainWindow->lineThickness());
+        }
+    }
+}
+
+void DataPlot::resizeEvent(
+        QResizeEvent *event)
+{
+    QCustomPlot::resizeEvent(event);
+
+    // Points are chosen for the width of the plot
+    if (mMainWindow && mMainWindow->dataSize() > 0
+            && event->size().width() != event->oldSize().width())
+    {
+        updatePlot();
+    }
 }
 
 void DataPlot::setMark(
@@ -269,25 +311,28 @@ void DataPlot::setMark(
 
     if (mMainWindow->dataSize() == 0) return;
 
+    const QDateTime startTime = DataPoint::dateTime(dpStart);
+    const QDateTime endTime = DataPoint::dateTime(dpEnd);
+
     QString status;
-    if (dpStart.dateTime.date() == dpEnd.dateTime.date())
+    if (startTime.date() == endTime.date())
     {
         status = QString("<p style='color:black;' align='center'><u>%1 %2.%3 to %4.%5 UTC</u></p>")
-                .arg(dpStart.dateTime.date().toString(Qt::ISODate))
-                .arg(dpStart.dateTime.time().toString(Qt::ISODate))
-                .arg(QString("%1").arg(dpStart.dateTime.time().msec(), 3, 10, QChar('0')))
-                .arg(dpEnd.dateTime.time().toString(Qt::ISODate))
-                .arg(QString("%1").arg(dpEnd.dateTime.time().msec(), 3, 10, QChar('0')));
+                .arg(startTime.date().toString(Qt::ISODate))
+                .arg(startTime.time().toString(Qt::ISODate))
+                .arg(QString("%1").arg(startTime.time().msec(), 3, 10, QChar('0')))
+                .arg(endTime.time().toString(Qt::ISODate))
+                .arg(QString("%1").arg(endTime.time().msec(), 3, 10, QChar('0')));
     }
     else
     {
         status = QString("<p style='color:black;' align='center'><u>%1 %2.%3 to %4 %5.%6 UTC</u></p>")
-                .arg(dpStart.dateTime.date().toString(Qt::ISODate))
-                .arg(dpStart.dateTime.time().toString(Qt::ISODate))
-                .arg(QString("%1").arg(dpStart.dateTime.time().msec(), 3, 10, QChar('0')))
-                .arg(dpEnd.dateTime.date().toString(Qt::ISODate))
-                .arg(dpEnd.dateTime.time().toString(Qt::ISODate))
-                .arg(QString("%1").arg(dpEnd.dateTime.time().msec(), 3, 10, QChar('0')));
+                .arg(startTime.date().toString(Qt::ISODate))
+                .arg(startTime.time().toString(Qt::ISODate))
+                .arg(QString("%1").arg(startTime.time().msec(), 3, 10, QChar('0')))
+                .arg(endTime.date().toString(Qt::ISODate))
+                .arg(endTime.time().toString(Qt::ISODate))
+                .arg(QString("%1").arg(endTime.time().msec(), 3, 10, QChar('0')));
     }
 
     status += QString("<table width='400'>");
@@ -330,8 +375,10 @@ void DataPlot::setMark(
     const int jMin = findIndexAboveX(low);
     const int jMax = findIndexBelowX(high);
 
-    const DataPoint &dpMin = mMainWindow->dataPoint(jMin);
-    const DataPoint &dpMax = mMainWindow->dataPoint(jMax);
+    const DataPoint dpMin = mMainWindow->dataPoint(jMin);
+    const DataPoint dpMax = mMainWindow->dataPoint(jMax);
+
+    updateValues();
 
     for (int i = 0; i < yaLast; ++i)
     {
@@ -348,25 +395,24 @@ void DataPlot::setMark(
             double min = yValue(i)->value(dpLow, mMainWindow->units());
             double max = min;
 
-            for (int j = jMin ; j < jMax ; ++ j)
-            {
-                const DataPoint &dp1 = mMainWindow->dataPoint(j);
-                const DataPoint &dp2 = mMainWindow->dataPoint(j + 1);
-
-                dx = m_xValues[Time]->value(dp2, mMainWindow->units())
-                        - m_xValues[Time]->value(dp1, mMainWindow->units());
-                avg = (yValue(i)->value(dp2, mMainWindow->units())
-                        + yValue(i)->value(dp1, mMainWindow->units())) / 2;
+            // Sums and extremes are kept without the offset
+            const double offset = yOffset(i);
 
-                sum += avg * fabs(dx) ;
-                dxSum += fabs(dx);
+            // Rows from jMin to jMax, from the running sums and pyramid
+            if (jMin < jMax)
+            {
+                const TrapezoidIntegral &rows = integral(i);
 
-                min = qMin(min, yValue(i)->value(dp1, mMainWindow->units()));
-                max = qMax(max, yValue(i)->value(dp1, mMainWindow->units()));
+                sum += rows.integral(jMin, jMax) - offset * rows.length(jMin, jMax);
+                dxSum += rows.length(jMin, jMax);
             }
 
-            min = qMin(min, yValue(i)->value(dpMax, mMainWindow->units()));
-            max = qMax(max, yValue(i)->value(dpMax, mMainWindow->units()));
+            double rowMin, rowMax;
+            if (mY[i].range(jMin, jMax + 1, rowMin, rowMax))
+            {
+                min = qMin(min, rowMin - offset);
+                max = qMax(max, rowMax - offset);
+            }
 
             dx = m_xValues[Time]->value(dpHigh, mMainWindow->units())
                     - m_xValues[Time]->value(dpMax, mMainWindow->units());
@@ -406,13 +452,15 @@ void DataPlot::setMark(
     DataPoint dp = interpolateDataX(mark);
     mMainWindow->setMark(dp.t);
 
+    const QDateTime dateTime = DataPoint::dateTime(dp);
+
     QString status;
     status = QString("<table width='300'>");
 
     status += QString("<tr style='color:black;'><td align='center'><u>%1 %2.%3 UTC</u></td></tr>")
-            .arg(dp.dateTime.date().toString(Qt::ISODate))
-            .arg(dp.dateTime.time().toString(Qt::ISODate))
-            .arg(QString("%1").arg(dp.dateTime.time().msec(), 3, 10, QChar('0')));
+            .arg(dateTime.date().toString(Qt::ISODate))
+            .arg(dateTime.time().toString(Qt::ISODate))
+            .arg(QString("%1").arg(dateTime.time().msec(), 3, 10, QChar('0')));
 
     status += QString("<tr style='color:black;'><td align='center'><u>(%1 deg, %2 deg, %3 m)</u></td></tr>")
             .arg(dp.lat, 0, 'f', 7)
@@ -465,56 +513,47 @@ void DataPlot::updateYRanges()
 {
     const QCPRange &range = xAxis->range();
 
+    updateValues();
+
+    // Rows within the range
+    const int begin = findIndexBelowX(range.lower) + 1;
+    const int end = findIndexAboveX(range.upper);
+
+    // Optimal rows within the range, whose x values are also in order
+    const QVector< double > &xOptimal = optimalXValues();
+    const int optimalBegin = std::lower_bound(xOptimal.begin(), xOptimal.end(), range.lower)
+            - xOptimal.begin();
+    const int optimalEnd = std::upper_bound(xOptimal.begin(), xOptimal.end(), range.upper)
+            - xOptimal.begin();
+
     int k = 0;
     for (int j = 0; j < yaLast; ++j)
     {
         if (!yValue(j)->visible()) continue;
 
         double yMin, yMax;
-        bool first = true;
+        bool first = !mY[j].range(begin, end, yMin, yMax);
 
-        for (int i = 0; i < mMainWindow->dataSize(); ++i)
+        if (!first)
         {
-            const DataPoint &dp = mMainWindow->dataPoint(i);
-
-            if (range.contains(xValue()->value(dp, mMainWindow->units())))
-            {
-                double y = yValue(j)->value(dp, mMainWindow->units());
-
-                if (first)
-                {
-                    yMin = yMax = y;
-                    first = false;
-                }
-                else
-                {
-                    if (y < yMin) yMin = y;
-                    if (y > yMax) yMax = y;
-                }
-            }
+            yMin -= yOffset(j);
+            yMax -= yOffset(j);
         }
 
-        if (yValue(j)->hasOptimal())
+        double yOptimalMin, yOptimalMax;
+        if (!mOptimalY[j].isEmpty()
+                && mOptimalY[j].range(optimalBegin, optimalEnd, yOptimalMin, yOptimalMax))
         {
-            for (int i = 0; i < mMainWindow->optimalSize(); ++i)
+            if (first)
+            {
+                yMin = yOptimalMin;
+                yMax = yOptimalMax;
+                first = false;
+            }
+            else
             {
-                const DataPoint &dp = mMainWindow->optimalPoint(i);
-
-                if (range.contains(xValue()->value(dp, mMainWindow->units())))
-                {
-                    double y = yValue(j)->value(dp, mMainWindow->units());
-
-                    if (first)
-                    {
-                        yMin = yMax = y;
-                        first = false;
-                    }
-                    else
-                    {
-                        if (y < yMin) yMin = y;
-                        if (y > yMax) yMax = y;
-                    }
-                }
+                yMin = qMin(yMin, yOptimalMin);
+                yMax = qMax(yMax, yOptimalMax);
             }
         }
 
@@ -528,22 +567,208 @@ void DataPlot::updateYRanges()
     }
 }
 
-void DataPlot::updatePlot()
+void DataPlot::updateValues()
 {
-    xAxis->setLabel(xValue()->title(mMainWindow->units()));
+    const TrackStore &track = mMainWindow->track();
+
+    if (mMainWindow->units() != mUnits
+            || mMainWindow->optimalRevision() != mOptimalRevision)
+    {
+        mOptimalRevision = mMainWindow->optimalRevision();
+
+        for (int k = 0; k < xaLast; ++k)
+        {
+            mOptimalX[k].clear();
+        }
+
+        for (int j = 0; j < yaLast; ++j)
+        {
+            mOptimalY[j].clear();
+        }
+    }
+
+    if (mMainWindow->units() != mUnits)
+    {
+        mRevision = track.revision();
+        mUnits = mMainWindow->units();
+
+        for (int k = 0; k < xaLast; ++k)
+        {
+            mX[k].clear();
+        }
+
+        for (int j = 0; j < yaLast; ++j)
+        {
+            mY[j].clear();
+            mIntegrals[j].clear();
+        }
+    }
+    else if (track.revision() != mRevision)
+    {
+        // Values of rows before the first one changed are kept, so rows
+        // added while a track streams in cost only their own values
+        const int first = track.firstChanged(mRevision);
+        mRevision = track.revision();
+
+        QVector< double > values;
+
+        for (int k = 0; k < xaLast; ++k)
+        {
+            if (mX[k].isEmpty()) continue;
+
+            m_xValues[k]->storedValues(track, mUnits, first, values);
+            mX[k].resize(first);
+            mX[k] += values;
+        }
+
+        for (int j = 0; j < yaLast; ++j)
+        {
+            if (mY[j].isEmpty()) continue;
+
+            if (!yValue(j)->visible())
+            {
+                mY[j].clear();
+                mIntegrals[j].clear();
+                continue;
+            }
+
+            yValue(j)->storedValues(track, mUnits, first, values);
+            mY[j].setValues(first, values);
+
+            if (!mIntegrals[j].isEmpty())
+            {
+                mIntegrals[j].setValues(mX[Time], mY[j].values(), first);
+            }
+        }
+    }
+
+    updateOptimalValues();
+
+    if (track.isEmpty()) return;
+
+    for (int j = 0; j < yaLast; ++j)
+    {
+        if (!yValue(j)->visible() || !mY[j].isEmpty()) continue;
 
-    QVector< double > x;
-    for (int i = 0; i < mMainWindow->dataSize(); ++i)
+        QVector< double > y;
+        yValue(j)->storedValues(track, mUnits, 0, y);
+        mY[j].setValues(y);
+    }
+}
+
+void DataPlot::updateOptimalValues()
+{
+    const TrackStore &optimal = mMainWindow->optimal();
+
+    if (optimal.isEmpty()) return;
+
+    for (int j = 0; j < yaLast; ++j)
     {
-        const DataPoint &dp = mMainWindow->dataPoint(i);
-        x.append(xValue()->value(dp, mMainWindow->units()));
+        if (!yValue(j)->visible() || !yValue(j)->hasOptimal()
+                || !mOptimalY[j].isEmpty()) continue;
+
+        // The optimum has no offsets, so its stored values are the values
+        QVector< double > y;
+        yValue(j)->storedValues(optimal, mUnits, 0, y);
+
+        mOptimalY[j].setValues(y);
     }
+}
+
+const QVector< double > &DataPlot::optimalXValues()
+{
+    updateValues();
+
+    const TrackStore &optimal = mMainWindow->optimal();
+    QVector< double > &x = mOptimalX[m_xAxisType];
+
+    if (x.isEmpty() && !optimal.isEmpty())
+    {
+        xValue()->storedValues(optimal, mUnits, 0, x);
+    }
+
+    return x;
+}
+
+const QVector< double > &DataPlot::xValues(
+        XAxisType xAxisType)
+{
+    updateValues();
+
+    const TrackStore &track = mMainWindow->track();
+
+    if (mX[xAxisType].isEmpty() && !track.isEmpty())
+    {
+        m_xValues[xAxisType]->storedValues(track, mUnits, 0, mX[xAxisType]);
+    }
+
+    return mX[xAxisType];
+}
+
+double DataPlot::xOffset(
+        XAxisType xAxisType) const
+{
+    return m_xValues[xAxisType]->offset(mMainWindow->track(), mUnits);
+}
+
+double DataPlot::yOffset(
+        int j) const
+{
+    return yValue(j)->offset(mMainWindow->track(), mUnits);
+}
+
+double DataPlot::convertX(
+        double x,
+        XAxisType xAxisType)
+{
+    // Value on another x axis at the same point along the track
+    const QVector< double > &from = xValues();
+    const QVector< double > &to = xValues(xAxisType);
+
+    if (to.isEmpty()) return x;
+
+    const int i1 = findIndexBelowX(x);
+    const int i2 = findIndexAboveX(x);
+
+    const double offset = xOffset(xAxisType);
+
+    if (i1 < 0)
+    {
+        return to.first() - offset;
+    }
+    else if (i2 >= to.size())
+    {
+        return to.last() - offset;
+    }
+    else
+    {
+        const double a = (x + xOffset() - from[i1]) / (from[i2] - from[i1]);
+        return to[i1] + a * (to[i2] - to[i1]) - offset;
+    }
+}
+
+const TrapezoidIntegral &DataPlot::integral(
+        int j)
+{
+    updateValues();
+
+    if (mIntegrals[j].isEmpty() && !mY[j].isEmpty())
+    {
+        mIntegrals[j].setValues(xValues(Time), mY[j].values());
+    }
+
+    return mIntegrals[j];
+}
+
+void DataPlot::updatePlot()
+{
+    xAxis->setLabel(xValue()->title(mMainWindow->units()));
+
+    updateValues();
 
     clearPlottables();
     clearItems();
 
-    m_cursors.clear();
-
     // Remove all axes
     while (axisRect()->axisCount(QCPAxis::atLeft) > 0)
     {
@@ -563,16 +788,40 @@ void DataPlot::updatePlot()
     DataPoint dpLower = mMainWindow->interpolateDataT(mMainWindow->rangeLower());
     DataPoint dpUpper = mMainWindow->interpolateDataT(mMainWindow->rangeUpper());
 
+    const double xLower = xValue()->value(dpLower, mMainWindow->units());
+    const double xUpper = xValue()->value(dpUpper, mMainWindow->units());
+
+    // Visible rows and one on either side, so lines reach the edges
+    const int begin = qMax(0, findIndexBelowX(xLower));
+    const QVector< double > &xs = xValues();
+    const int end = qMin(xs.size(), findIndexAboveX(xUpper) + 1);
+
+    // About two points per pixel, keeping the extremes of each pixel
+    const int plotWidth = (axisRect()->width() > 0) ? axisRect()->width() : width();
+    const int maxPoints = 2 * plotWidth;
+
+    QVector< int > rows;
+    QVector< double > x, y;
+
+    const double xOff = xOffset();
+
     // Draw plots
     for (int j = 0; j < yaLast; ++j)
     {
         if (!yValue(j)->visible()) continue;
 
-        QVector< double > y;
-        for (int i = 0; i < mMainWindow->dataSize(); ++i)
+        const QVector< double > &values = mY[j].values();
+        mY[j].decimate(begin, end, maxPoints, rows);
+
+        const double yOff = yOffset(j);
+
+        x.resize(rows.size());
+        y.resize(rows.size());
+
+        for (int k = 0; k < rows.size(); ++k)
         {
-            const DataPoint &dp = mMainWindow->dataPoint(i);
-            y.append(yValue(j)->value(dp, mMainWindow->units()));
+            x[k] = xs[rows[k]] - xOff;
+            y[k] = values[rows[k]] - yOff;
         }
 
         QCPAxis *axis = yValue(j)->axis();
@@ -584,18 +833,10 @@ void DataPlot::updatePlot()
 
         if (yValue(j)->hasOptimal())
         {
-            QVector< double > xOptimal, yOptimal;
-            for (int i = 0; i < mMainWindow->optimalSize(); ++i)
-            {
-                const DataPoint &dp = mMainWindow->optimalPoint(i);
-                xOptimal.append(xValue()->value(dp, mMainWindow->units()));
-                yOptimal.append(yValue(j)->value(dp, mMainWindow->units()));
-            }
-
             QCPGraph *graph = addGraph(
                         axisRect()->axis(QCPAxis::atBottom),
                         axis);
-            graph->setData(xOptimal, yOptimal);
+            graph->setData(optimalXValues(), mOptimalY[j].values());
             graph->setPen(QPen(QBrush(yValue(j)->color()), mMainWindow->lineThickness(), Qt::DotLine));
         }
     }
@@ -603,10 +844,7 @@ void DataPlot::updatePlot()
     // Set x-axis range
     if (mMainWindow->dataSize() > 0)
     {
-        const double xMin = xValue()->value(dpLower, mMainWindow->units());
-        const double xMax = xValue()->value(dpUpper, mMainWindow->units());
-
-        xAxis->setRange(QCPRange(xMin, xMax));
+        xAxis->setRange(QCPRange(xLower, xUpper));
     }
 
     if (mMainWindow->windAdjustment())
@@ -628,46 +866,13 @@ void DataPlot::updatePlot()
 
     updateYRanges();
 
-    updateCursor();
+    replot();
 }
 
 void DataPlot::updateCursor()
 {
-    for (int i = 0; i < m_cursors.size(); ++i)
-    {
-        removeGraph(m_cursors[i]);
-    }
-
-    m_cursors.clear();
-
-    // Draw mark
-    if (mMainWindow->markActive())
-    {
-        const DataPoint &dpEnd = mMainWindow->interpolateDataT(mMainWindow->markEnd());
-
-        QVector< double > xMark, yMark;
-        xMark.append(xValue()->value(dpEnd, mMainWindow->units()));
-
-        for (int j = 0; j < yaLast; ++j)
-        {
-            if (!yValue(j)->visible()) continue;
-
-            yMark.clear();
-            yMark.append(yValue(j)->value(dpEnd, mMainWindow->units()));
-
-            QCPAxis *axis = yValue(j)->axis();
-            QCPGraph *graph = addGraph(xAxis, axis);
-
-            graph->setData(xMark, yMark);
-            graph->setPen(QPen(Qt::black, mMainWindow->lineThickness()));
-            graph->setLineStyle(QCPGraph::lsNone);
-            graph->setScatterStyle(QCPScatterStyle::ssDisc);
-
-            m_cursors.push_back(graph);
-        }
-    }
-
-    replot();
+    // The mark is drawn over the plot when it is painted
+    update();
 }
 
 DataPoint DataPlot::interpolateDataX(
@@ -686,27 +891,33 @@ DataPoint DataPlot::interpolateDataX(
     }
     else
     {
-        const DataPoint &dp1 = mMainWindow->dataPoint(i1);
-        const DataPoint &dp2 = mMainWindow->dataPoint(i2);
-        const double x1 = xValue()->value(dp1, mMainWindow->units());
-        const double x2 = xValue()->value(dp2, mMainWindow->units());
-        return DataPoint::interpolate(dp1, dp2, (x - x1) / (x2 - x1));
+        const DataPoint dp1 = mMainWindow->dataPoint(i1);
+        const DataPoint dp2 = mMainWindow->dataPoint(i2);
+        const QVector< double > &xs = xValues();
+        const double x1 = xs[i1];
+        const double x2 = xs[i2];
+        return DataPoint::interpolate(dp1, dp2, (x + xOffset() - x1) / (x2 - x1));
     }
 }
 
 int DataPlot::findIndexBelowX(
         double x)
 {
+    // Time is looked up in the track's own index
+    if (m_xAxisType == Time) return mMainWindow->findIndexBelowT(x);
+
+    const QVector< double > &xs = xValues();
+    const double raw = x + xOffset();
+
     int below = -1;
-    int above = mMainWindow->dataSize();
+    int above = xs.size();
 
     while (below + 1 != above)
     {
         int mid = (below + above) / 2;
-        const DataPoint &dp = mMainWindow->dataPoint(mid);
 
-        if (xValue()->value(dp, mMainWindow->units()) < x) below = mid;
-        else                                               above = mid;
+        if (xs[mid] < raw) below = mid;
+        else             above = mid;
     }
 
     return below;
@@ -715,16 +926,20 @@ int DataPlot::findIndexBelowX(
 int DataPlot::findIndexAboveX(
         double x)
 {
+    if (m_xAxisType == Time) return mMainWindow->findIndexAboveT(x);
+
+    const QVector< double > &xs = xValues();
+    const double raw = x + xOffset();
+
     int below = -1;
-    int above = mMainWindow->dataSize();
+    int above = xs.size();
 
     while (below + 1 != above)
     {
         int mid = (below + above) / 2;
-        const DataPoint &dp = mMainWindow->dataPoint(mid);
 
-        if (xValue()->value(dp, mMainWindow->units()) > x) above = mid;
-        else                                               below = mid;
+        if (xs[mid] > raw) above = mid;
+        else             below = mid;
     }
 
     return above;
@@ -742,13 +957,12 @@ void DataPlot::setXAxisType(
 {
     const QCPRange &range = xAxis->range();
 
-    DataPoint dpLower = interpolateDataX(range.lower);
-    DataPoint dpUpper = interpolateDataX(range.upper);
+    const double lower = convertX(range.lower, xAxisType);
+    const double upper = convertX(range.upper, xAxisType);
 
     m_xAxisType = xAxisType;
 
-    xAxis->setRange(QCPRange(xValue()->value(dpLower, mMainWindow->units()),
-                             xValue()->value(dpUpper, mMainWindow->units())));
+    xAxis->setRange(QCPRange(lower, upper));
 
     updatePlot();
 }
@@ -2,7 +2,9 @@
 #define DATAPLOT_H
 
 #include "datapoint.h"
+#include "minmaxpyramid.h"
 #include "plotvalue.h"
+#include "trapezoidintegral.h"
 #include "qcustomplot.h"
 
 class MainWindow;
@@ -15,7 +17,8 @@ public:
     typedef enum {
         Time = 0,
         Distance2D,
-        Distance3D
+        Distance3D,
+        xaLast
     } XAxisType;
 
     typedef enum {
@@ -65,6 +68,7 @@ protected:
     void leaveEvent(QEvent *);
 
     void paintEvent(QPaintEvent *event);
+    void resizeEvent(QResizeEvent *event);
 
 private:
     QPoint m_cursorPos;
@@ -78,8 +82,33 @@ private:
     XAxisType             m_xAxisType;
 
     QVector< PlotValue* > m_yValues;
-    QVector< QCPGraph* >  m_cursors;
 
+    // Values of the track revision and units last plotted: each x axis once
+    // it is used, with pyramids for the visible plots and integrals for
+    // those measured. They are kept as stored, without the offsets of the
+    // track, which are taken off as they are read.
+    quint32                         mRevision;
+    PlotValue::Units                mUnits;
+    QVector< QVector< double > >    mX;
+    QVector< MinMaxPyramid >        mY;
+    QVector< TrapezoidIntegral >    mIntegrals;
+
+    // The same for the optimal track, for plots that show it; its x values
+    // increase like the track's, so ranges are found by binary search
+    quint32                         mOptimalRevision;
+    QVector< QVector< double > >    mOptimalX;
+    QVector< MinMaxPyramid >        mOptimalY;
+
+    void updateValues();
+    void updateOptimalValues();
+    const QVector< double > &optimalXValues();
+    const QVector< double > &xValues(XAxisType xAxisType);
+    const QVector< double > &xValues() { return xValues(m_xAxisType); }
+    double xOffset(XAxisType xAxisType) const;
+    double xOffset() const { return xOffset(m_xAxisType); }
+    double yOffset(int j) const;
+    double convertX(double x, XAxisType xAxisType);
+    const TrapezoidIntegral &integral(int j);
     void updateYRanges();
     void setRange(const QCPRange &range);
 
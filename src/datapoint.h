@@ -10,7 +10,7 @@
 class DataPoint
 {
 public:
-    QDateTime   dateTime;
+    qint64      timestamp;  // Milliseconds since epoch (UTC)
 
     bool        hasGeodetic;
 
@@ -55,6 +55,11 @@ public:
                                  const DataPoint &p2,
                                  double a);
 
+    static QDateTime dateTime(const DataPoint &dp)
+    {
+        return QDateTime::fromMSecsSinceEpoch(dp.timestamp, Qt::UTC);
+    }
+
     static double elevation(const DataPoint &dp)
     {
         return dp.z;
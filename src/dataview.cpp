@@ -116,26 +116,28 @@ void DataView::updateView()
 
     bool first = true;
 
-    for (int i = 0; i < mMainWindow->dataSize(); ++i)
-    {
-        const DataPoint &dp = mMainWindow->dataPoint(i);
+    const TrackStore &track = mMainWindow->track();
+
+    const TrackStore::Span spanT = track.column(TrackStore::T);
+    const TrackStore::Span spanX = track.column(TrackStore::X);
+    const TrackStore::Span spanY = track.column(TrackStore::Y);
+    const TrackStore::Span spanZ = track.column(TrackStore::Z);
 
-        if (lower <= dp.t && dp.t <= upper)
+    for (int i = 0; i < track.size(); ++i)
+    {
+        if (lower <= spanT[i] && spanT[i] <= upper)
         {
-            t.append(dp.t);
+            const double u = spanX[i];
+            const double v = spanY[i];
 
-            if (mMainWindow->units() == PlotValue::Metric)
-            {
-                x.append(dp.x *  cos(mMainWindow->rotation()) + dp.y * sin(mMainWindow->rotation()));
-                y.append(dp.x * -sin(mMainWindow->rotation()) + dp.y * cos(mMainWindow->rotation()));
-                z.append(dp.z);
-            }
-            else
-            {
-                x.append((dp.x *  cos(mMainWindow->rotation()) + dp.y * sin(mMainWindow->rotation())) * METERS_TO_FEET);
-                y.append((dp.x * -sin(mMainWindow->rotation()) + dp.y * cos(mMainWindow->rotation())) * METERS_TO_FEET);
-                z.append((dp.z) * METERS_TO_FEET);
-            }
+            t.append(spanT[i]);
+
+            double xView, yView, zView;
+            viewPosition(u, v, spanZ[i], xView, yView, zView);
+
+            x.append(xView);
+            y.append(yView);
+            z.append(zView);
 
             if (first)
             {
@@ -143,8 +145,8 @@ void DataView::updateView()
                 yMin = yMax = y.back();
                 zMin = zMax = z.back();
 
-                uMin = uMax = dp.x;
-                vMin = vMax = dp.y;
+                uMin = uMax = u;
+                vMin = vMax = v;
 
                 first = false;
             }
@@ -159,19 +161,17 @@ void DataView::updateView()
                 if (z.back() < zMin) zMin = z.back();
                 if (z.back() > zMax) zMax = z.back();
 
-                if (dp.x < uMin) uMin = dp.x;
-                if (dp.x > uMax) uMax = dp.x;
+                if (u < uMin) uMin = u;
+                if (u > uMax) uMax = u;
 
-                if (dp.y < vMin) vMin = dp.y;
-                if (dp.y > vMax) vMax = dp.y;
+                if (v < vMin) vMin = v;
+                if (v > vMax) vMax = v;
             }
         }
     }
 
     clearPlottables();
 
-    m_cursors.clear();
-
     QCPCurve *curve = new QCPCurve(xAxis, yAxis);
     switch (mDirection)
     {
@@ -253,18 +253,12 @@ void DataView::updateView()
             dp.x = distance * sin(bearing);
             dp.y = distance * cos(bearing);
 
-            if (mMainWindow->units() == PlotValue::Metric)
-            {
-                xMark.append(dp.x *  cos(mMainWindow->rotation()) + dp.y * sin(mMainWindow->rotation()));
-                yMark.append(dp.x * -sin(mMainWindow->rotation()) + dp.y * cos(mMainWindow->rotation()));
-                zMark.append(dp.z);
-            }
-            else
-            {
-                xMark.append((dp.x *  cos(mMainWindow->rotation()) + dp.y * sin(mMainWindow->rotation())) * METERS_TO_FEET);
-                yMark.append((dp.x * -sin(mMainWindow->rotation()) + dp.y * cos(mMainWindow->rotation())) * METERS_TO_FEET);
-                zMark.append((dp.z) * METERS_TO_FEET);
-            }
+            double xView, yView, zView;
+            viewPosition(dp.x, dp.y, dp.z, xView, yView, zView);
+
+            xMark.append(xView);
+            yMark.append(yView);
+            zMark.append(zView);
         }
 
         QCPGraph *graph = addGraph();
@@ -290,58 +284,62 @@ void DataView::updateView()
         addNorthArrow();
     }
 
-    updateCursor();
+    replot();
 }
 
 void DataView::updateCursor()
 {
-    for (int i = 0; i < m_cursors.size(); ++i)
-    {
-        removeGraph(m_cursors[i]);
-    }
+    // The mark is drawn over the plot when it is painted
+    update();
+}
 
-    m_cursors.clear();
+void DataView::paintEvent(
+        QPaintEvent *event)
+{
+    QCustomPlot::paintEvent(event);
 
     if (mMainWindow->markActive())
     {
-        const DataPoint &dpEnd = mMainWindow->interpolateDataT(mMainWindow->markEnd());
+        const DataPoint dpEnd = mMainWindow->markPoint();
 
-        QVector< double > xMark, yMark, zMark;
-
-        if (mMainWindow->units() == PlotValue::Metric)
-        {
-            xMark.append(dpEnd.x *  cos(mMainWindow->rotation()) + dpEnd.y * sin(mMainWindow->rotation()));
-            yMark.append(dpEnd.x * -sin(mMainWindow->rotation()) + dpEnd.y * cos(mMainWindow->rotation()));
-            zMark.append(dpEnd.z);
-        }
-        else
-        {
-            xMark.append((dpEnd.x *  cos(mMainWindow->rotation()) + dpEnd.y * sin(mMainWindow->rotation())) * METERS_TO_FEET);
-            yMark.append((dpEnd.x * -sin(mMainWindow->rotation()) + dpEnd.y * cos(mMainWindow->rotation())) * METERS_TO_FEET);
-            zMark.append((dpEnd.z) * METERS_TO_FEET);
-        }
+        double xMark, yMark, zMark;
+        viewPosition(dpEnd.x, dpEnd.y, dpEnd.z, xMark, yMark, zMark);
 
-        QCPGraph *graph = addGraph();
+        QPointF mark;
         switch (mDirection)
         {
         case Top:
-            graph->setData(xMark, yMark);
+            mark = QPointF(xMark, yMark);
             break;
         case Left:
-            graph->setData(xMark, zMark);
+            mark = QPointF(xMark, zMark);
             break;
         case Front:
-            graph->setData(yMark, zMark);
+            mark = QPointF(yMark, zMark);
             break;
         }
-        graph->setPen(QPen(Qt::black, mMainWindow->lineThickness()));
-        graph->setLineStyle(QCPGraph::lsNone);
-        graph->setScatterStyle(QCPScatterStyle::ssDisc);
 
-        m_cursors.push_back(graph);
+        QPainter painter(this);
+        drawCursor(&painter, xAxis, yAxis, mark.x(), mark.y(),
+                   mMainWindow->lineThickness());
     }
+}
 
-    replot();
+void DataView::viewPosition(
+        double u,
+        double v,
+        double w,
+        double &x,
+        double &y,
+        double &z) const
+{
+    // Rotated into the view and converted to display units
+    const double rotation = mMainWindow->rotation();
+    const double factor = PlotValue::distanceFactor(mMainWindow->units());
+
+    x = (u *  cos(rotation) + v * sin(rotation)) * factor;
+    y = (u * -sin(rotation) + v * cos(rotation)) * factor;
+    z = w * factor;
 }
 
 void DataView::addNorthArrow()
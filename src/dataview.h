@@ -28,6 +28,8 @@ protected:
     void mouseReleaseEvent(QMouseEvent *event);
     void mouseMoveEvent(QMouseEvent *event);
 
+    void paintEvent(QPaintEvent *event);
+
 private:
     MainWindow *mMainWindow;
 
@@ -36,12 +38,13 @@ private:
     QPoint      m_topViewBeginPos;
     bool        m_topViewPan;
 
-    QVector< QCPGraph* >  m_cursors;
-
     void setViewRange(double xMin, double xMax,
                       double yMin, double yMax);
     void addNorthArrow();
 
+    void viewPosition(double u, double v, double w,
+                      double &x, double &y, double &z) const;
+
 public slots:
     void updateView();
     void updateCursor();
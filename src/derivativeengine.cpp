@@ -0,0 +1,272 @@
+#include "derivativeengine.h"
+
+#include <math.h>
+
+// Sums for a least-squares line through a set of rows. Times and values are
+// relative to an origin near the rows.
+class SlopeSums
+{
+public:
+    explicit SlopeSums(int numValues):
+        mT0(0), mN(0), mSumT(0), mSumTT(0),
+        mOrigin(numValues), mSumY(numValues), mSumTY(numValues)
+    {
+
+    }
+
+    void reset(double t0, const double *y0)
+    {
+        mT0 = t0;
+        mN = mSumT = mSumTT = 0;
+
+        for (int j = 0; j < mOrigin.size(); ++j)
+        {
+            mOrigin[j] = y0[j];
+            mSumY[j] = mSumTY[j] = 0;
+        }
+    }
+
+    // Add (sign = 1) or remove (sign = -1) a row
+    void add(double t, const double *y, double sign)
+    {
+        const double dt = t - mT0;
+
+        mN += sign;
+        mSumT += sign * dt;
+        mSumTT += sign * dt * dt;
+
+        for (int j = 0; j < mOrigin.size(); ++j)
+        {
+            const double dy = y[j] - mOrigin[j];
+            mSumY[j] += sign * dy;
+            mSumTY[j] += sign * dt * dy;
+        }
+    }
+
+    void slopes(double *result) const
+    {
+        // Sum of squared deviations from the mean time, which is zero when
+        // all of the times are the same
+        const double stt = mSumTT - mSumT * mSumT / mN;
+        const bool valid = (stt > 1e-12 * mSumTT);
+
+        for (int j = 0; j < mOrigin.size(); ++j)
+        {
+            const double sty = mSumTY[j] - mSumT * mSumY[j] / mN;
+            result[j] = valid ? sty / stt : 0;
+        }
+    }
+
+private:
+    double            mT0;
+    double            mN;
+    double            mSumT;
+    double            mSumTT;
+
+    QVector< double > mOrigin;
+    QVector< double > mSumY;
+    QVector< double > mSumTY;
+};
+
+DerivativeEngine::DerivativeEngine(
+        double window):
+    mWindow(window)
+{
+
+}
+
+void DerivativeEngine::setWindow(
+        double window)
+{
+    mWindow = window;
+}
+
+void DerivativeEngine::compute(
+        const QVector< DataPoint > &data,
+        int begin,
+        int end,
+        const Value *values,
+        int numValues,
+        QVector< double > &result) const
+{
+    result.resize((end - begin) * numValues);
+    if (begin >= end) return;
+
+    // Sums are rebuilt at the first row of each bucket, and carried forward
+    // from there, so every caller gets the same result for a row however it
+    // splits up the track
+    const int start = bucketStart(data, begin);
+
+    // Evaluate each value once for every row in any window, row by row
+    int lo, hi, iMin, iMax;
+    range(data, start, lo, iMax);
+    range(data, end - 1, iMin, hi);
+
+    QVector< double > rows((hi - lo + 1) * numValues);
+    for (int k = lo; k <= hi; ++k)
+    {
+        double *y = rows.data() + (k - lo) * numValues;
+        for (int j = 0; j < numValues; ++j)
+        {
+            y[j] = values[j](data[k]);
+        }
+    }
+
+    // Rows [a, b] within half a window of row i. Both bounds only move
+    // forward, so each row is added to and removed from the sums once.
+    const double half = mWindow / 2;
+
+    SlopeSums sums(numValues);
+    int a = lo, b = lo - 1;
+    double current = 0;
+
+    double *out = result.data();
+
+    for (int i = start; i < end; ++i)
+    {
+        const double t = data[i].t;
+
+        while (b < hi && data[b + 1].t <= t + half)
+        {
+            ++b;
+            sums.add(data[b].t, rows.constData() + (b - lo) * numValues, 1);
+        }
+
+        while (data[a].t < t - half)
+        {
+            sums.add(data[a].t, rows.constData() + (a - lo) * numValues, -1);
+            ++a;
+        }
+
+        // Move the origin to this row once per bucket, so the sums stay well
+        // conditioned and rounding doesn't build up
+        const double next = bucket(t);
+        if (i == start || next != current)
+        {
+            current = next;
+            sums.reset(t, rows.constData() + (i - lo) * numValues);
+            for (int k = a; k <= b; ++k)
+            {
+                sums.add(data[k].t, rows.constData() + (k - lo) * numValues, 1);
+            }
+        }
+
+        // Rows before begin only bring the sums up to date
+        if (i < begin) continue;
+
+        // At least one row on either side, as in range(), added for this
+        // row only
+        const int before = (a == i && i > 0) ? i - 1 : -1;
+        const int after = (b == i && i + 1 < data.size()) ? i + 1 : -1;
+
+        if (before >= 0) sums.add(data[before].t, rows.constData() + (before - lo) * numValues, 1);
+        if (after >= 0) sums.add(data[after].t, rows.constData() + (after - lo) * numValues, 1);
+
+        sums.slopes(out);
+
+        if (before >= 0) sums.add(data[before].t, rows.constData() + (before - lo) * numValues, -1);
+        if (after >= 0) sums.add(data[after].t, rows.constData() + (after - lo) * numValues, -1);
+
+        out += numValues;
+    }
+}
+
+void DerivativeEngine::update(
+        QVector< DataPoint > &data,
+        int begin,
+        int end,
+        const Value *values,
+        double DataPoint::*const *slopes,
+        int numValues) const
+{
+    QVector< double > result;
+    compute(data, begin, end, values, numValues, result);
+
+    const double *in = result.constData();
+    for (int i = begin; i < end; ++i)
+    {
+        DataPoint &dp = data[i];
+        for (int j = 0; j < numValues; ++j)
+        {
+            dp.*slopes[j] = *in++;
+        }
+    }
+}
+
+void DerivativeEngine::range(
+        const QVector< DataPoint > &data,
+        int i,
+        int &iMin,
+        int &iMax) const
+{
+    const double half = mWindow / 2;
+    const double t = data[i].t;
+
+    iMin = iMax = i;
+
+    while (iMin > 0 && data[iMin - 1].t >= t - half) --iMin;
+    while (iMax + 1 < data.size() && data[iMax + 1].t <= t + half) ++iMax;
+
+    // At least one row on either side
+    if (iMin == i && i > 0) iMin = i - 1;
+    if (iMax == i && i + 1 < data.size()) iMax = i + 1;
+}
+
+double DerivativeEngine::bucket(
+        double t) const
+{
+    return floor(t / (mWindow > 0 ? mWindow : 1));
+}
+
+int DerivativeEngine::bucketStart(
+        const QVector< DataPoint > &data,
+        int i) const
+{
+    const double current = bucket(data[i].t);
+    while (i > 0 && bucket(data[i - 1].t) == current) --i;
+
+    return i;
+}
+
+int DerivativeEngine::firstNeeded(
+        const QVector< DataPoint > &data,
+        int begin) const
+{
+    if (begin >= data.size()) return begin;
+
+    int iMin, iMax;
+    range(data, bucketStart(data, begin), iMin, iMax);
+
+    return iMin;
+}
+
+int DerivativeEngine::firstAffected(
+        const QVector< DataPoint > &data,
+        int begin) const
+{
+    if (begin <= 0) return 0;
+    if (begin >= data.size()) return begin;
+
+    const double half = mWindow / 2;
+
+    // The row before begin always reaches it
+    int first = begin - 1;
+    while (first > 0 && data[begin].t <= data[first - 1].t + half) --first;
+
+    return first;
+}
+
+int DerivativeEngine::completeRows(
+        const QVector< DataPoint > &data,
+        int end) const
+{
+    if (end <= 0) return 0;
+
+    const double half = mWindow / 2;
+
+    // Rows whose window ends before the last row
+    int ready = end - 1;
+    while (ready > 0 && data[end - 1].t <= data[ready - 1].t + half) --ready;
+
+    return ready;
+}
@@ -0,0 +1,59 @@
+#ifndef DERIVATIVEENGINE_H
+#define DERIVATIVEENGINE_H
+
+#include <QVector>
+
+#include "datapoint.h"
+
+// Least-squares slopes of several values over a window of fixed length in
+// time, centred on each row. The window slides forward with running sums of
+// the times and values, so each row costs the same however many rows the
+// window holds. The sums start again at the first row of every window-long
+// bucket of time, which keeps them accurate and makes each result
+// independent of the rows a caller asks for. Rows must be in time order.
+// Each row uses at least one row on either side where available, so gaps in
+// the data still give a slope.
+
+class DerivativeEngine
+{
+public:
+    typedef double (*Value)(const DataPoint &);
+
+    explicit DerivativeEngine(double window = 1.0);
+
+    // Total length of the window in seconds
+    void setWindow(double window);
+    double window() const { return mWindow; }
+
+    // Slopes of numValues values for rows [begin, end), stored row by row
+    void compute(const QVector< DataPoint > &data, int begin, int end,
+                 const Value *values, int numValues,
+                 QVector< double > &result) const;
+
+    // As above, storing each slope in a member of its row
+    void update(QVector< DataPoint > &data, int begin, int end,
+                const Value *values, double DataPoint::*const *slopes,
+                int numValues) const;
+
+    // Rows [iMin, iMax] used for the slope at row i
+    void range(const QVector< DataPoint > &data, int i,
+               int &iMin, int &iMax) const;
+
+    // First row read by compute() for rows from begin onwards
+    int firstNeeded(const QVector< DataPoint > &data, int begin) const;
+
+    // First row whose slope depends on rows from begin onwards
+    int firstAffected(const QVector< DataPoint > &data, int begin) const;
+
+    // Number of leading rows whose slopes don't depend on rows after end
+    int completeRows(const QVector< DataPoint > &data, int end) const;
+
+private:
+    double mWindow;
+
+    // Rows are grouped into buckets one window long, by time
+    double bucket(double t) const;
+    int bucketStart(const QVector< DataPoint > &data, int i) const;
+};
+
+#endif // DERIVATIVEENGINE_H
@@ -1,5 +1,7 @@
 #include "genome.h"
 
+#include "atmosphere.h"
+
 Genome::Genome()
 {
 
@@ -199,8 +201,7 @@ QVector< DataPoint > Genome::simulate(
         pt.dist2D = dist2D;
         pt.dist3D = dist3D;
 
-        // curv
-        // accel
+        // Slopes are added by MainWindow::setOptimal
 
         pt.lift = lift_next;
         pt.drag = drag_next;
@@ -222,17 +223,8 @@ double Genome::dtheta_dt(
         double planformArea,
         double mass)
 {
-    // From https://en.wikipedia.org/wiki/Atmospheric_pressure#Altitude_variation
-    const double airPressure = SL_PRESSURE * pow(1 - LAPSE_RATE * y / SL_TEMP, A_GRAVITY * MM_AIR / GAS_CONST / LAPSE_RATE);
-
-    // From https://en.wikipedia.org/wiki/Lapse_rate
-    const double temperature = SL_TEMP - LAPSE_RATE * y;
-
-    // From https://en.wikipedia.org/wiki/Density_of_air
-    const double airDensity = airPressure / (GAS_CONST / MM_AIR) / temperature;
-
     // From https://en.wikipedia.org/wiki/Dynamic_pressure
-    const double dynamicPressure = airDensity * v * v / 2;
+    const double dynamicPressure = Atmosphere::density(y) * v * v / 2;
 
     // Calculate acceleration due to drag and lift
     const double accelLift = dynamicPressure * planformArea * lift / mass;
@@ -249,17 +241,8 @@ double Genome::dv_dt(
         double planformArea,
         double mass)
 {
-    // From https://en.wikipedia.org/wiki/Atmospheric_pressure#Altitude_variation
-    const double airPressure = SL_PRESSURE * pow(1 - LAPSE_RATE * y / SL_TEMP, A_GRAVITY * MM_AIR / GAS_CONST / LAPSE_RATE);
-
-    // From https://en.wikipedia.org/wiki/Lapse_rate
-    const double temperature = SL_TEMP - LAPSE_RATE * y;
-
-    // From https://en.wikipedia.org/wiki/Density_of_air
-    const double airDensity = airPressure / (GAS_CONST / MM_AIR) / temperature;
-
     // From https://en.wikipedia.org/wiki/Dynamic_pressure
-    const double dynamicPressure = airDensity * v * v / 2;
+    const double dynamicPressure = Atmosphere::density(y) * v * v / 2;
 
     // Calculate acceleration due to drag and lift
     const double accelDrag = dynamicPressure * planformArea * drag / mass;
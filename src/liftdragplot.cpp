@@ -155,14 +155,20 @@ void LiftDragPlot::updatePlot()
     double s10 = 0, s01 = 0, s20 = 0, s11 = 0;
     double s21 = 0, s30 = 0, s40 = 0;
 
+    const TrackStore &track = mMainWindow->track();
+    const TrackStore::Span spanT = track.column(TrackStore::T);
+    const TrackStore::Span spanLift = track.column(TrackStore::Lift);
+    const TrackStore::Span spanDrag = track.column(TrackStore::Drag);
+
     bool first = true;
     for (int i = start; i < end; ++i)
     {
-        const DataPoint &dp = mMainWindow->dataPoint(i);
+        const double lift = spanLift[i];
+        const double drag = spanDrag[i];
 
-        t.append(dp.t);
-        x.append(dp.drag);
-        y.append(dp.lift);
+        t.append(spanT[i]);
+        x.append(drag);
+        y.append(lift);
 
         if (first)
         {
@@ -177,13 +183,13 @@ void LiftDragPlot::updatePlot()
             if (y.back() > yMax) yMax = y.back();
         }
 
-        s10 += dp.lift;
-        s01 += dp.drag;
-        s20 += dp.lift * dp.lift;
-        s11 += dp.lift * dp.drag;
-        s21 += dp.lift * dp.lift * dp.drag;
-        s30 += dp.lift * dp.lift * dp.lift;
-        s40 += dp.lift * dp.lift * dp.lift * dp.lift;
+        s10 += lift;
+        s01 += drag;
+        s20 += lift * lift;
+        s11 += lift * drag;
+        s21 += lift * lift * drag;
+        s30 += lift * lift * lift;
+        s40 += lift * lift * lift * lift;
     }
 
     QCPCurve *curve = new QCPCurve(xAxis, yAxis);
@@ -202,34 +208,6 @@ void LiftDragPlot::updatePlot()
     yMin = yAxis->range().lower;
     yMax = yAxis->range().upper;
 
-    if (mMainWindow->markActive())
-    {
-        int i1 = mMainWindow->findIndexBelowT(mMainWindow->markEnd()) + 1;
-        int i2 = mMainWindow->findIndexAboveT(mMainWindow->markEnd()) - 1;
-
-        const DataPoint &dp1 = mMainWindow->dataPoint(i1);
-        const DataPoint &dp2 = mMainWindow->dataPoint(i2);
-
-        QVector< double > xMark, yMark;
-
-        if (mMainWindow->markEnd() - dp1.t < dp2.t - mMainWindow->markEnd())
-        {
-            xMark.append(dp1.drag);
-            yMark.append(dp1.lift);
-        }
-        else
-        {
-            xMark.append(dp2.drag);
-            yMark.append(dp2.lift);
-        }
-
-        QCPGraph *graph = addGraph();
-        graph->setData(xMark, yMark);
-        graph->setPen(QPen(Qt::black, mMainWindow->lineThickness()));
-        graph->setLineStyle(QCPGraph::lsNone);
-        graph->setScatterStyle(QCPScatterStyle::ssDisc);
-    }
-
     // x = ay^2 + c
     const double m = 1 / mMainWindow->maxLD();
     const double c = mMainWindow->minDrag();
@@ -332,6 +310,28 @@ void LiftDragPlot::updatePlot()
     replot();
 }
 
+void LiftDragPlot::updateCursor()
+{
+    // The mark is drawn over the plot when it is painted
+    update();
+}
+
+void LiftDragPlot::paintEvent(
+        QPaintEvent *event)
+{
+    QCustomPlot::paintEvent(event);
+
+    if (mMainWindow->markActive())
+    {
+        // Lift and drag are drawn at the sample nearest the mark
+        const DataPoint dp = mMainWindow->nearestDataT(mMainWindow->markEnd());
+
+        QPainter painter(this);
+        drawCursor(&painter, xAxis, yAxis, dp.drag, dp.lift,
+                   mMainWindow->lineThickness());
+    }
+}
+
 void LiftDragPlot::setViewRange(
         double xMax,
         double yMax)
@@ -21,6 +21,8 @@ protected:
     void mouseReleaseEvent(QMouseEvent *event);
     void mouseMoveEvent(QMouseEvent *event);
 
+    void paintEvent(QPaintEvent *event);
+
 private:
     MainWindow *mMainWindow;
 
@@ -32,6 +34,7 @@ private:
 
 public slots:
     void updatePlot();
+    void updateCursor();
 };
 
 #endif // LIFTDRAGPLOT_H
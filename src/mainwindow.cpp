@@ -1,24 +1,28 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 
+#include <QDir>
 #include <QDockWidget>
 #include <QFile>
 #include <QFileDialog>
 #include <QFileInfo>
+#include <QFileSystemWatcher>
 #include <QMessageBox>
 #include <QProgressDialog>
 #include <QSettings>
 #include <QShortcut>
 #include <QTextStream>
 #include <QThread>
+#include <QtConcurrentMap>
 
-#include <math.h>
+#include <algorithm>
 
-#include "GeographicLib/Geodesic.hpp"
+#include <math.h>
 
 #include "common.h"
 #include "configdialog.h"
 #include "dataview.h"
+#include "derivativeengine.h"
 #include "importworker.h"
 #include "liftdragplot.h"
 #include "mapview.h"
@@ -28,18 +32,22 @@
 #include "ppcscoring.h"
 #include "scoringview.h"
 #include "speedscoring.h"
+#include "trackcatalog.h"
+#include "trackimporter.h"
+#include "trackinflater.h"
+#include "trackparser.h"
+#include "trackview.h"
 #include "videoview.h"
 #include "wideopendistancescoring.h"
 #include "wideopenspeedscoring.h"
 #include "windplot.h"
 
-using namespace GeographicLib;
-
 MainWindow::MainWindow(
         QWidget *parent):
 
     QMainWindow(parent),
     m_ui(new Ui::MainWindow),
+    mOptimalRevision(0),
     mMarkActive(false),
     m_viewDataRotation(0),
     m_units(PlotValue::Imperial),
@@ -58,10 +66,23 @@ MainWindow::MainWindow(
     mWindAdjustment(false),
     mScoringMode(PPC),
     mGroundReference(Automatic),
-    mFixedReference(0)
+    mFixedReference(0),
+    mExactGeodesic(false),
+    mCompactStorage(false),
+    mSlopeWindow(1.0),
+    mImportId(0),
+    mResidentTracks(10),
+    mTimeReference(0),
+    mFollowPosition(0)
 {
     m_ui->setupUi(this);
 
+    // No track loaded yet
+    mOrigin.hasGeodetic = false;
+    mOrigin.x = mOrigin.y = 0;
+
+    clearOffsets();
+
     // Initialize scoring methods
     mScoringMethods.append(new PPCScoring(this));
     mScoringMethods.append(new SpeedScoring(this));
@@ -89,6 +110,20 @@ MainWindow::MainWindow(
     // Read settings
     readSettings();
 
+    // Initialize track catalog
+    mTrackCatalog = new TrackCatalog(this);
+    mTrackCatalog->setLimit(mResidentTracks);
+    mTrackCatalog->setCompact(mCompactStorage);
+
+    connect(mTrackCatalog, SIGNAL(trackLoaded(QString)),
+            this, SLOT(trackLoaded(QString)));
+
+    // Initialize track follower
+    mFollowWatcher = new QFileSystemWatcher(this);
+
+    connect(mFollowWatcher, SIGNAL(fileChanged(QString)),
+            this, SLOT(followTrack(QString)));
+
     // Intitialize plot area
     initPlot();
 
@@ -111,6 +146,9 @@ MainWindow::MainWindow(
     // Initialize playback controls
     initPlaybackView();
 
+    // Initialize track list
+    initTrackView();
+
     // Restore window state
     QSettings settings("FlySight", "Viewer");
     settings.beginGroup("mainWindow");
@@ -135,10 +173,56 @@ MainWindow::MainWindow(
 
     // Start worker thread
     thread->start();
+
+    // Create track import worker
+    qRegisterMetaType< QVector< DataPoint > >("QVector< DataPoint >");
+    qRegisterMetaType< TrackProcessor >("TrackProcessor");
+    qRegisterMetaType< TrackStore >("TrackStore");
+
+    mImportThread = new QThread(this);
+    mImporter = new TrackImporter;
+    mImporter->moveToThread(mImportThread);
+
+    connect(mImportThread, SIGNAL(finished()), mImporter, SLOT(deleteLater()));
+
+    // Attach track import worker
+    connect(this, SIGNAL(importRequested(int, QString, TrackProcessor, bool)),
+            mImporter, SLOT(importFile(int, QString, TrackProcessor, bool)));
+    connect(this, SIGNAL(cacheRequested(int, TrackStore, TrackProcessor)),
+            mImporter, SLOT(writeCache(int, TrackStore, TrackProcessor)));
+    connect(mImporter, SIGNAL(started(int, TrackProcessor)),
+            this, SLOT(importStarted(int, TrackProcessor)));
+    connect(mImporter, SIGNAL(chunkReady(int, QVector< DataPoint >, int)),
+            this, SLOT(importChunk(int, QVector< DataPoint >, int)));
+    connect(mImporter, SIGNAL(trackReady(int, TrackStore)),
+            this, SLOT(importTrack(int, TrackStore)));
+    connect(mImporter, SIGNAL(progressChanged(int, int)),
+            this, SLOT(importProgress(int, int)));
+    connect(mImporter, SIGNAL(finished(int, int)),
+            this, SLOT(importFinished(int, int)));
+
+    // Initialize import progress
+    mImportProgress = new QProgressDialog(tr("Importing..."), tr("Cancel"), 0, 100, this);
+    mImportProgress->setWindowModality(Qt::WindowModal);
+    mImportProgress->setAutoReset(false);
+    mImportProgress->setAutoClose(false);
+    mImportProgress->setMinimumDuration(0);
+    mImportProgress->reset();
+
+    connect(mImportProgress, SIGNAL(canceled()),
+            this, SLOT(cancelImport()));
+
+    // Start import thread
+    mImportThread->start();
 }
 
 MainWindow::~MainWindow()
 {
+    // Stop track import
+    mImporter->setActive(-1);
+    mImportThread->quit();
+    mImportThread->wait();
+
     delete m_ui;
 }
 
@@ -163,6 +247,10 @@ void MainWindow::writeSettings()
         settings.setValue("scoringMode", mScoringMode);
         settings.setValue("groundReference", mGroundReference);
         settings.setValue("fixedReference", mFixedReference);
+        settings.setValue("residentTracks", mResidentTracks);
+        settings.setValue("exactGeodesic", mExactGeodesic);
+        settings.setValue("compactStorage", mCompactStorage);
+        settings.setValue("slopeWindow", mSlopeWindow);
     settings.endGroup();
 }
 
@@ -185,6 +273,10 @@ void MainWindow::readSettings()
         mScoringMode = (ScoringMode) settings.value("scoringMode", mScoringMode).toInt();
     	mGroundReference = (GroundReference) settings.value("groundReference", mGroundReference).toInt();
 	    mFixedReference = settings.value("fixedReference", mFixedReference).toDouble();
+        mResidentTracks = settings.value("residentTracks", mResidentTracks).toInt();
+        mExactGeodesic = settings.value("exactGeodesic", mExactGeodesic).toBool();
+        mCompactStorage = settings.value("compactStorage", mCompactStorage).toBool();
+        mSlopeWindow = settings.value("slopeWindow", mSlopeWindow).toDouble();
     settings.endGroup();
 }
 
@@ -278,7 +370,7 @@ void MainWindow::initWindView()
     connect(this, SIGNAL(dataChanged()),
             windPlot, SLOT(updatePlot()));
     connect(this, SIGNAL(cursorChanged()),
-            windPlot, SLOT(updatePlot()));
+            windPlot, SLOT(updateCursor()));
 }
 
 void MainWindow::initScoringView()
@@ -322,7 +414,7 @@ void MainWindow::initLiftDragView()
     connect(this, SIGNAL(dataChanged()),
             liftDragPlot, SLOT(updatePlot()));
     connect(this, SIGNAL(cursorChanged()),
-            liftDragPlot, SLOT(updatePlot()));
+            liftDragPlot, SLOT(updateCursor()));
     connect(this, SIGNAL(aeroChanged()),
             liftDragPlot, SLOT(updatePlot()));
 }
@@ -346,7 +438,7 @@ void MainWindow::initOrthoView()
     connect(this, SIGNAL(dataChanged()),
             orthoView, SLOT(updateView()));
     connect(this, SIGNAL(cursorChanged()),
-            orthoView, SLOT(updateView()));
+            orthoView, SLOT(updateCursor()));
 }
 
 void MainWindow::initPlaybackView()
@@ -371,6 +463,28 @@ void MainWindow::initPlaybackView()
             playbackView, SLOT(updateView()));
 }
 
+void MainWindow::initTrackView()
+{
+    TrackView *trackView = new TrackView;
+    QDockWidget *dockWidget = new QDockWidget(tr("Tracks"));
+    dockWidget->setWidget(trackView);
+    dockWidget->setObjectName("trackView");
+    dockWidget->setVisible(false);
+    addDockWidget(Qt::BottomDockWidgetArea, dockWidget);
+
+    trackView->setMainWindow(this);
+
+    connect(m_ui->actionShowTrackView, SIGNAL(toggled(bool)),
+            dockWidget, SLOT(setVisible(bool)));
+    connect(dockWidget, SIGNAL(visibilityChanged(bool)),
+            m_ui->actionShowTrackView, SLOT(setChecked(bool)));
+
+    connect(mTrackCatalog, SIGNAL(catalogChanged()),
+            trackView, SLOT(updateView()));
+    connect(this, SIGNAL(dataLoaded()),
+            trackView, SLOT(updateView()));
+}
+
 void MainWindow::closeEvent(
         QCloseEvent *event)
 {
@@ -387,62 +501,68 @@ void MainWindow::closeEvent(
     event->accept();
 }
 
-DataPoint MainWindow::interpolateDataT(
+void MainWindow::moveZero(
         double t)
 {
-    const int i1 = findIndexBelowT(t);
-    const int i2 = findIndexAboveT(t);
+    // Values at t become zero
+    const DataPoint dp0 = m_data.interpolateT(t);
 
-    if (i1 < 0)
-    {
-        return m_data.first();
-    }
-    else if (i2 >= m_data.size())
-    {
-        return m_data.last();
-    }
-    else
-    {
-        const DataPoint &dp1 = m_data[i1];
-        const DataPoint &dp2 = m_data[i2];
-        return DataPoint::interpolate(dp1, dp2, (t - dp1.t) / (dp2.t - dp1.t));
-    }
+    m_data.setOffset(TrackStore::T, m_data.offset(TrackStore::T) + dp0.t);
+    m_data.setOffset(TrackStore::X, m_data.offset(TrackStore::X) + dp0.x);
+    m_data.setOffset(TrackStore::Y, m_data.offset(TrackStore::Y) + dp0.y);
+
+    m_data.setOffset(TrackStore::Dist2D, m_data.offset(TrackStore::Dist2D) + dp0.dist2D);
+    m_data.setOffset(TrackStore::Dist3D, m_data.offset(TrackStore::Dist3D) + dp0.dist3D);
 }
 
-int MainWindow::findIndexBelowT(
+void MainWindow::clearOffsets()
+{
+    mHasZero = false;
+    m_data.clearOffsets();
+}
+
+DataPoint MainWindow::interpolateDataT(
         double t)
 {
-    int below = -1;
-    int above = m_data.size();
+    return m_data.interpolateT(t);
+}
 
-    while (below + 1 != above)
-    {
-        int mid = (below + above) / 2;
-        const DataPoint &dp = m_data[mid];
+DataPoint MainWindow::nearestDataT(
+        double t) const
+{
+    int below, above;
+    double fraction;
+    bracketT(t, below, above, fraction);
 
-        if (dp.t < t) below = mid;
-        else          above = mid;
-    }
+    // Last row at or before t and first row at or after it
+    const int i1 = qMax(above - 1, 0);
+    const int i2 = qMin(below + 1, dataSize() - 1);
+
+    const DataPoint dp1 = dataPoint(i1);
+    const DataPoint dp2 = dataPoint(i2);
 
-    return below;
+    return (t - dp1.t <= dp2.t - t) ? dp1 : dp2;
 }
 
-int MainWindow::findIndexAboveT(
+int MainWindow::findIndexBelowT(
         double t)
 {
-    int below = -1;
-    int above = m_data.size();
-
-    while (below + 1 != above)
-    {
-        int mid = (below + above) / 2;
-        const DataPoint &dp = m_data[mid];
+    return m_data.findIndexBelowT(t);
+}
 
-        if (dp.t > t) above = mid;
-        else          below = mid;
-    }
+int MainWindow::findIndexAboveT(
+        double t)
+{
+    return m_data.findIndexAboveT(t);
+}
 
-    return above;
+void MainWindow::bracketT(
+        double t,
+        int &below,
+        int &above,
+        double &fraction) const
+{
+    m_data.bracketT(t, below, above, fraction);
 }
 
 void MainWindow::on_actionImport_triggered()
@@ -450,371 +570,432 @@ void MainWindow::on_actionImport_triggered()
     // Initialize settings object
     QSettings settings("FlySight", "Viewer");
 
-    // Get file to import
-    importFile(QFileDialog::getOpenFileName(this,
-                                            tr("Import Track"),
-                                            settings.value("folder").toString(),
-                                            tr("CSV Files (*.csv)")));
+    // Get files to import
+    importFiles(QFileDialog::getOpenFileNames(this,
+                                              tr("Import Track"),
+                                              settings.value("folder").toString(),
+                                              tr("CSV Files (*.csv *.csv.gz *.gz)")));
 }
 
-void MainWindow::importFile(
-        QString fileName)
+void MainWindow::on_actionImportFolder_triggered()
 {
     // Initialize settings object
     QSettings settings("FlySight", "Viewer");
 
-    QFile file(fileName);
-    if (!file.open(QIODevice::ReadOnly))
+    // Get folder to import
+    QString folder = QFileDialog::getExistingDirectory(this,
+                                                       tr("Import Folder"),
+                                                       QFileInfo(settings.value("folder").toString()).absolutePath());
+    if (folder.isEmpty()) return;
+
+    // Import all tracks in folder
+    QStringList fileNames;
+    foreach (const QFileInfo &info,
+             QDir(folder).entryInfoList(QStringList() << "*.csv" << "*.CSV" << "*.csv.gz" << "*.CSV.GZ",
+                                        QDir::Files, QDir::Name))
+    {
+        fileNames.append(info.absoluteFilePath());
+    }
+
+    importFiles(fileNames);
+}
+
+void MainWindow::importFiles(
+        const QStringList &fileNames)
+{
+    if (fileNames.isEmpty()) return;
+
+    if (fileNames.size() == 1)
     {
-        // TODO: Error message
+        importFile(fileNames.first());
         return;
     }
 
+    // Initialize settings object
+    QSettings settings("FlySight", "Viewer");
+
     // Remember last file read
-    settings.setValue("folder", QFileInfo(fileName).absoluteFilePath());
+    settings.setValue("folder", QFileInfo(fileNames.first()).absoluteFilePath());
 
-    QTextStream in(&file);
-
-    // Column enumeration
-    typedef enum {
-        Time = 0,
-        Lat,
-        Lon,
-        HMSL,
-        VelN,
-        VelE,
-        VelD,
-        HAcc,
-        VAcc,
-        SAcc,
-        Heading,
-        CAcc,
-        NumSV
-    } Columns;
-
-    // Read column labels
-    QMap< int, int > colMap;
-    if (!in.atEnd())
-    {
-        QString line = in.readLine();
-        QStringList cols = line.split(",");
+    // Load tracks in parallel and show the first one when it's ready
+    mTrackCatalog->load(fileNames, trackProcessor(), mGroundReference == Automatic);
+    mPendingTrack = fileNames.first();
 
-        for (int i = 0; i < cols.size(); ++i)
-        {
-            const QString &s = cols[i];
-
-            if (s == "time")    colMap[Time]    = i;
-            if (s == "lat")     colMap[Lat]     = i;
-            if (s == "lon")     colMap[Lon]     = i;
-            if (s == "hMSL")    colMap[HMSL]    = i;
-            if (s == "velN")    colMap[VelN]    = i;
-            if (s == "velE")    colMap[VelE]    = i;
-            if (s == "velD")    colMap[VelD]    = i;
-            if (s == "hAcc")    colMap[HAcc]    = i;
-            if (s == "vAcc")    colMap[VAcc]    = i;
-            if (s == "sAcc")    colMap[SAcc]    = i;
-            if (s == "numSV")   colMap[NumSV]   = i;
-        }
+    m_ui->actionShowTrackView->setChecked(true);
+}
+
+void MainWindow::trackLoaded(
+        const QString &fileName)
+{
+    if (fileName == mPendingTrack)
+    {
+        mPendingTrack.clear();
+        selectTrack(fileName);
     }
+}
 
-    // Skip next row
-    if (!in.atEnd()) in.readLine();
+void MainWindow::selectTrack(
+        const QString &fileName)
+{
+    if (fileName == mTrackName && !m_data.isEmpty()) return;
 
-    m_data.clear();
+    TrackStore track;
+    TrackProcessor processor;
 
-    while (!in.atEnd())
+    if (!mTrackCatalog->get(fileName, track, processor))
     {
-        QString line = in.readLine();
-        QStringList cols = line.split(",");
+        if (mTrackCatalog->isLoading(fileName))
+        {
+            // Show track when it's ready
+            mPendingTrack = fileName;
+        }
+        else
+        {
+            importFile(fileName);
+        }
+        return;
+    }
 
-        DataPoint pt;
+    // Stop any import in progress
+    mImporter->setActive(++mImportId);
+    mImportProgress->reset();
 
-        pt.dateTime = QDateTime::fromString(cols[colMap[Time]], Qt::ISODate);
+    mTrackName = fileName;
+    mPendingTrack.clear();
 
-        pt.hasGeodetic = true;
+    m_data = track;
+    m_data.setCompact(mCompactStorage);
+    mTimeReference = processor.timeReference();
+    mOrigin = processor.origin();
+    clearOffsets();
 
-        pt.lat   = cols[colMap[Lat]].toDouble();
-        pt.lon   = cols[colMap[Lon]].toDouble();
-        pt.hMSL  = cols[colMap[HMSL]].toDouble();
+    // Clear optimum
+    m_optimal.clear();
+    ++mOptimalRevision;
 
-        pt.velN  = cols[colMap[VelN]].toDouble();
-        pt.velE  = cols[colMap[VelE]].toDouble();
-        pt.velD  = cols[colMap[VelD]].toDouble();
+    // Recompute derived values if settings have changed since loading
+    mProcessor = processor;
+    updateDerived();
 
-        pt.hAcc  = cols[colMap[HAcc]].toDouble();
-        pt.vAcc  = cols[colMap[VAcc]].toDouble();
-        pt.sAcc  = cols[colMap[SAcc]].toDouble();
+    initRange();
+    initFollow();
 
-        pt.numSV = cols[colMap[NumSV]].toDouble();
+    emit dataLoaded();
+}
 
-        m_data.append(pt);
-    }
+void MainWindow::importFile(
+        QString fileName)
+{
+    // Initialize settings object
+    QSettings settings("FlySight", "Viewer");
 
-    // Initialize time
-    for (int i = 0; i < m_data.size(); ++i)
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
     {
-        const DataPoint &dp0 = m_data[m_data.size() - 1];
-        DataPoint &dp = m_data[i];
+        QMessageBox::warning(this, tr("Import Track"),
+                             tr("Couldn't open %1.\n\n%2")
+                             .arg(QDir::toNativeSeparators(fileName))
+                             .arg(file.errorString()));
+        return;
+    }
 
-        qint64 start = dp0.dateTime.toMSecsSinceEpoch();
-        qint64 end = dp.dateTime.toMSecsSinceEpoch();
+    // Remember last file read
+    settings.setValue("folder", QFileInfo(fileName).absoluteFilePath());
 
-        dp.t = (double) (end - start) / 1000;
-    }
+    // Stop any import in progress
+    mImporter->setActive(++mImportId);
 
-    // Altitude above ground
-    initAltitude();
+    mTrackName = fileName;
+    mPendingTrack.clear();
 
-    // Wind adjustments
-    updateVelocity();
+    m_data.clear();
+    m_data.setCompact(mCompactStorage);
+    clearOffsets();
+    initFollow();
 
     // Clear optimum
     m_optimal.clear();
+    ++mOptimalRevision;
 
-    initRange();
+    mImportProgress->setValue(0);
 
-    emit dataLoaded();
+    emit dataChanged();
+    emit importRequested(mImportId, fileName, trackProcessor(),
+                         mGroundReference == Automatic);
 }
 
-void MainWindow::initAltitude()
+void MainWindow::importStarted(
+        int id,
+        const TrackProcessor &processor)
 {
+    if (id != mImportId) return;
+
+    // Altitude above ground
     if (mGroundReference == Automatic)
     {
-        const DataPoint &dp0 = m_data[m_data.size() - 1];
-        mFixedReference = dp0.hMSL;
+        mFixedReference = processor.groundReference();
     }
 
-    for (int i = 0; i < m_data.size(); ++i)
-    {
-        DataPoint &dp = m_data[i];
-        dp.z = dp.hMSL - mFixedReference;
-    }
+    // Rows are timed and positioned relative to the last one
+    mTimeReference = processor.timeReference();
+    mOrigin = processor.origin();
+    mProcessor = processor;
 }
 
-void MainWindow::updateVelocity()
+void MainWindow::importChunk(
+        int id,
+        const QVector< DataPoint > &data,
+        int progress)
 {
-    if (mWindAdjustment)
-    {
-        // Wind-adjusted position
-        for (int i = 0; i < m_data.size(); ++i)
-        {
-            const DataPoint &dp0 = interpolateDataT(0);
-            DataPoint &dp = m_data[i];
+    // Ignore chunks from canceled imports
+    if (id != mImportId) return;
 
-            double distance = getDistance(dp0, dp);
-            double bearing = getBearing(dp0, dp);
+    const bool first = m_data.isEmpty();
 
-            dp.x = distance * sin(bearing) - mWindE * dp.t;
-            dp.y = distance * cos(bearing) - mWindN * dp.t;
-        }
+    m_data.append(data);
 
-        // Wind-adjusted velocity
-        for (int i = 0; i < m_data.size(); ++i)
-        {
-            DataPoint &dp = m_data[i];
+    if (first)
+    {
+        // The last row is at t = 0, so the full range is already known
+        initRange(m_data.rawValue(0, TrackStore::T), 0);
 
-            dp.vx = dp.velE - mWindE;
-            dp.vy = dp.velN - mWindN;
-        }
+        emit dataLoaded();
     }
     else
     {
-        // Unadjusted position
-        for (int i = 0; i < m_data.size(); ++i)
-        {
-            const DataPoint &dp0 = interpolateDataT(0);
-            DataPoint &dp = m_data[i];
+        emit dataChanged();
+    }
 
-            double distance = getDistance(dp0, dp);
-            double bearing = getBearing(dp0, dp);
+    mImportProgress->setValue(progress);
+}
 
-            dp.x = distance * sin(bearing);
-            dp.y = distance * cos(bearing);
-        }
+void MainWindow::importTrack(
+        int id,
+        const TrackStore &track)
+{
+    if (id != mImportId) return;
 
-        // Unadjusted velocity
-        for (int i = 0; i < m_data.size(); ++i)
-        {
-            DataPoint &dp = m_data[i];
+    // Cached tracks share their columns with the importer
+    m_data = track;
+    m_data.setCompact(mCompactStorage);
 
-            dp.vx = dp.velE;
-            dp.vy = dp.velN;
-        }
-    }
+    if (m_data.isEmpty()) return;
 
-    // Distance measurements
-    double dist2D = 0, dist3D = 0;
+    initRange(m_data.rawValue(0, TrackStore::T), 0);
 
-    for (int i = 0; i < m_data.size(); ++i)
-    {
-        DataPoint &dp = m_data[i];
+    emit dataLoaded();
 
-        if (i > 0)
-        {
-            const DataPoint &dpPrev = m_data[i - 1];
+    mImportProgress->setValue(100);
+}
+
+void MainWindow::importProgress(
+        int id,
+        int progress)
+{
+    if (id != mImportId) return;
+
+    mImportProgress->setValue(progress);
+}
+
+void MainWindow::importFinished(
+        int id,
+        int status)
+{
+    if (id != mImportId) return;
 
-            double dx = dp.x - dpPrev.x;
-            double dy = dp.y - dpPrev.y;
-            double dh = sqrt(dx * dx + dy * dy);
-            double dz = dp.hMSL - dpPrev.hMSL;
+    mImportProgress->reset();
 
-            dist2D += dh;
-            dist3D += sqrt(dh * dh + dz * dz);
+    if (status != TrackImporter::Completed)
+    {
+        QString reason;
+        switch (status)
+        {
+        case TrackImporter::OpenFailed:
+            reason = tr("The file could not be opened.");
+            break;
+        case TrackImporter::NoRows:
+            reason = tr("The file has no rows that could be read.");
+            break;
+        case TrackImporter::Corrupt:
+            reason = tr("The compressed data is corrupt or incomplete.");
+            break;
+        default:
+            return;
         }
 
-        dp.dist2D = dist2D;
-        dp.dist3D = dist3D;
+        QMessageBox::warning(this, tr("Import Track"),
+                             tr("Couldn't import %1.\n\n%2")
+                             .arg(QDir::toNativeSeparators(mTrackName))
+                             .arg(reason));
+        return;
     }
 
-    // Cumulative heading
-    double prevHeading;
-    bool firstHeading = true;
+    if (m_data.isEmpty()) return;
 
-    for (int i = 0; i < m_data.size(); ++i)
-    {
-        DataPoint &dp = m_data[i];
+    // Cache the rows the importer streamed, sharing their columns
+    emit cacheRequested(id, m_data, mProcessor);
 
-        // Calculate heading
-        dp.heading = atan2(dp.vx, dp.vy) / PI * 180;
+    // Keep track for quick switching
+    shareTrack();
 
-        // Calculate heading accuracy
-        const double s = DataPoint::totalSpeed(dp);
-        if (s != 0) dp.cAcc = dp.sAcc / s;
-        else        dp.cAcc = 0;
+    initRange();
+    initFollow();
 
-        // Adjust heading
-        if (!firstHeading)
-        {
-            while (dp.heading <  prevHeading - 180) dp.heading += 360;
-            while (dp.heading >= prevHeading + 180) dp.heading -= 360;
-        }
+    emit dataLoaded();
+}
 
-        // Relative heading
-        dp.theta = dp.heading;
+void MainWindow::cancelImport()
+{
+    // Keep rows received so far
+    mImporter->setActive(++mImportId);
+    mImportProgress->reset();
 
-        firstHeading = false;
-        prevHeading = dp.heading;
-    }
+    if (m_data.isEmpty()) return;
 
-    // Parameters depending on velocity
-    for (int i = 0; i < m_data.size(); ++i)
-    {
-        DataPoint &dp = m_data[i];
+    initRange();
+    initFollow();
 
-        dp.curv = getSlope(i, DataPoint::diveAngle);
-        dp.accel = getSlope(i, DataPoint::totalSpeed);
-        dp.omega = getSlope(i, DataPoint::course);
-    }
+    emit dataLoaded();
+}
 
-    // Initialize aerodynamics
-    initAerodynamics();
+void MainWindow::on_actionFollowTrack_triggered()
+{
+    initFollow();
 }
 
-void MainWindow::initAerodynamics()
+void MainWindow::initFollow()
 {
-    for (int i = 0; i < m_data.size(); ++i)
+    // Stop watching previous track
+    if (!mFollowWatcher->files().isEmpty())
     {
-        DataPoint &dp = m_data[i];
+        mFollowWatcher->removePaths(mFollowWatcher->files());
+    }
+
+    // Compressed logs are read from the start, so they can't be followed
+    const bool compressed = TrackInflater::isCompressed(mTrackName);
+    m_ui->actionFollowTrack->setEnabled(!compressed);
 
-        // Acceleration
-        double accelN = getSlope(i, DataPoint::northSpeed);
-        double accelE = getSlope(i, DataPoint::eastSpeed);
-        double accelD = getSlope(i, DataPoint::verticalSpeed);
+    if (compressed) return;
+    if (!m_ui->actionFollowTrack->isChecked() || m_data.isEmpty()) return;
 
-        // Subtract acceleration due to gravity
-        accelD -= A_GRAVITY;
+    // Continue after the last row we have
+    TrackParser parser;
 
-        // Calculate acceleration due to drag
-        const double vel = DataPoint::totalSpeed(dp);
-        const double proj = (accelN * dp.vy + accelE * dp.vx + accelD * dp.velD) / vel;
+    if (!parser.open(mTrackName)) return;
 
-        const double dragN = proj * dp.vy / vel;
-        const double dragE = proj * dp.vx / vel;
-        const double dragD = proj * dp.velD / vel;
+    parser.excludePartialRow();
+    if (!parser.seekAfter(m_data.timestamp(m_data.size() - 1))) return;
 
-        const double accelDrag = sqrt(dragN * dragN + dragE * dragE + dragD * dragD);
+    mFollowPosition = parser.position();
+    mFollowWatcher->addPath(mTrackName);
+}
 
-        // Calculate acceleration due to lift
-        const double liftN = accelN - dragN;
-        const double liftE = accelE - dragE;
-        const double liftD = accelD - dragD;
+void MainWindow::followTrack(
+        const QString &fileName)
+{
+    if (fileName != mTrackName || m_data.isEmpty()) return;
 
-        const double accelLift = sqrt(liftN * liftN + liftE * liftE + liftD * liftD);
+    // Rows within the slope window of the end, followed by complete rows
+    // appended since the last update
+    const double tEnd = m_data.value(m_data.size() - 1, TrackStore::T);
+    const int start = qMax(0, m_data.findIndexBelowT(tEnd - mSlopeWindow) - 1);
 
-        // From https://en.wikipedia.org/wiki/Atmospheric_pressure#Altitude_variation
-        const double airPressure = SL_PRESSURE * pow(1 - LAPSE_RATE * dp.hMSL / SL_TEMP, A_GRAVITY * MM_AIR / GAS_CONST / LAPSE_RATE);
+    QVector< DataPoint > rows = m_data.rawRows(start);
+    const int begin = rows.size();
 
-        // From https://en.wikipedia.org/wiki/Lapse_rate
-        const double temperature = SL_TEMP - LAPSE_RATE * dp.hMSL;
+    TrackParser parser;
 
-        // From https://en.wikipedia.org/wiki/Density_of_air
-        const double airDensity = airPressure / (GAS_CONST / MM_AIR) / temperature;
+    if (parser.open(fileName))
+    {
+        parser.excludePartialRow();
 
-        // From https://en.wikipedia.org/wiki/Dynamic_pressure
-        const double dynamicPressure = airDensity * vel * vel / 2;
+        if (parser.seek(mFollowPosition))
+        {
+            parser.readRows(rows);
+            mFollowPosition = parser.position();
+        }
+    }
 
-        // Calculate lift and drag coefficients
-        dp.lift = m_mass * accelLift / dynamicPressure / m_planformArea;
-        dp.drag = m_mass * accelDrag / dynamicPressure / m_planformArea;
+    // Files replaced by renaming are no longer watched
+    if (!mFollowWatcher->files().contains(fileName) && QFile::exists(fileName))
+    {
+        mFollowWatcher->addPath(fileName);
     }
-}
 
-double MainWindow::getSlope(
-        const int center,
-        double (*value)(const DataPoint &)) const
-{
-    int iMin = qMax (0, center - 2);
-    int iMax = qMin (m_data.size () - 1, center + 2);
+    if (rows.size() == begin) return;
 
-    double sumx = 0, sumy = 0, sumxx = 0, sumxy = 0;
+    // Derived values for the new rows only
+    TrackProcessor processor = trackProcessor();
+    processor.setTimeReference(rows[begin - 1].timestamp);
+    processor.appendRows(rows, begin, rows.size());
 
-    for (int i = iMin; i <= iMax; ++i)
-    {
-        const DataPoint &dp = m_data[i];
-        double y = value(dp);
+    m_data.setRows(start, rows);
+    shareTrack();
 
-        sumx += dp.t;
-        sumy += y;
-        sumxx += dp.t * dp.t;
-        sumxy += dp.t * y;
+    // Keep the end of the track in view
+    if (mZoomLevel.rangeUpper >= rows[begin - 1].t)
+    {
+        mZoomLevel.rangeUpper = rows.last().t;
     }
 
-    int n = iMax - iMin + 1;
-    return (sumxy - sumx * sumy / n) / (sumxx - sumx * sumx / n);
+    emit dataChanged();
 }
 
-double MainWindow::getDistance(
-        const DataPoint &dp1,
-        const DataPoint &dp2)
+TrackProcessor MainWindow::trackProcessor() const
 {
-    if (dp1.hasGeodetic && dp2.hasGeodetic)
-    {
-        const Geodesic &geod = Geodesic::WGS84();
-        double s12;
+    TrackProcessor processor;
 
-        geod.Inverse(dp1.lat, dp1.lon, dp2.lat, dp2.lon, s12);
+    processor.setWind(mWindAdjustment, mWindE, mWindN);
+    processor.setAerodynamics(m_mass, m_planformArea);
+    processor.setGround(mFixedReference);
+    processor.setTimeReference(mTimeReference);
+    processor.setOrigin(mOrigin);
+    processor.setExactGeodesic(mExactGeodesic);
+    processor.setSlopeWindow(mSlopeWindow);
+    processor.setParallel(true);
 
-        return s12;
-    }
-    else
-    {
-        const double dx = dp2.x - dp1.x;
-        const double dy = dp2.y - dp1.y;
+    return processor;
+}
 
-        return sqrt(dx * dx + dy * dy);
+void MainWindow::shareTrack()
+{
+    // The catalog keeps the same columns as the view, and the copy it had
+    // before is released
+    if (!m_data.isEmpty())
+    {
+        mTrackCatalog->insert(mTrackName, m_data, mProcessor);
     }
 }
 
-double MainWindow::getBearing(
-        const DataPoint &dp1,
-        const DataPoint &dp2)
+void MainWindow::updateDerived()
 {
-    const Geodesic &geod = Geodesic::WGS84();
-    double azi1, azi2;
+    if (m_data.isEmpty()) return;
 
-    geod.Inverse(dp1.lat, dp1.lon, dp2.lat, dp2.lon, azi1, azi2);
+    // Altitude above ground
+    if (mGroundReference == Automatic)
+    {
+        mFixedReference = m_data.rawValue(m_data.size() - 1, TrackStore::HMSL);
+    }
+
+    // Only values depending on changed settings are recomputed
+    const TrackProcessor processor = trackProcessor();
+    const int columns = processor.changedColumns(mProcessor);
+    if (!columns) return;
 
-    return azi1 / 180 * PI;
+    // Rows are updated in blocks, without copying the whole track
+    processor.update(m_data, mProcessor);
+
+    mProcessor = processor;
+    shareTrack();
+
+    // Tool offsets of recomputed values
+    if (columns & TrackProcessor::Altitude) m_data.setOffset(TrackStore::Z, 0);
+    if (columns & TrackProcessor::Heading) m_data.setOffset(TrackStore::Theta, 0);
+
+    if (mHasZero && (columns & (TrackProcessor::Position | TrackProcessor::Distance)))
+    {
+        moveZero(0);
+    }
 }
 
 void MainWindow::setMark(
@@ -823,10 +1004,16 @@ void MainWindow::setMark(
 {
     if (m_data.isEmpty()) return;
 
-    if (start >= m_data.front().t &&
-            start <= m_data.back().t &&
-            end >= m_data.front().t &&
-            end <= m_data.back().t)
+    start += m_data.offset(TrackStore::T);
+    end += m_data.offset(TrackStore::T);
+
+    const double front = m_data.rawValue(0, TrackStore::T);
+    const double back = m_data.rawValue(m_data.size() - 1, TrackStore::T);
+
+    if (start >= front &&
+            start <= back &&
+            end >= front &&
+            end <= back)
     {
         mMarkStart = start;
         mMarkEnd = end;
@@ -845,8 +1032,10 @@ void MainWindow::setMark(
 {
     if (m_data.isEmpty()) return;
 
-    if (mark >= m_data.front().t &&
-            mark <= m_data.back().t)
+    mark += m_data.offset(TrackStore::T);
+
+    if (mark >= m_data.rawValue(0, TrackStore::T) &&
+            mark <= m_data.rawValue(m_data.size() - 1, TrackStore::T))
     {
         mMarkStart = mMarkEnd = mark;
         mMarkActive = true;
@@ -868,23 +1057,30 @@ void MainWindow::clearMark()
 
 void MainWindow::initRange()
 {
-    double lower, upper;
+    double lower = 0, upper = 0;
 
     for (int i = 0; i < m_data.size(); ++i)
     {
-        DataPoint &dp = m_data[i];
+        const double t = m_data.rawValue(i, TrackStore::T);
 
         if (i == 0)
         {
-            lower = upper = dp.t;
+            lower = upper = t;
         }
         else
         {
-            if (dp.t < lower) lower = dp.t;
-            if (dp.t > upper) upper = dp.t;
+            if (t < lower) lower = t;
+            if (t > upper) upper = t;
         }
     }
 
+    initRange(lower, upper);
+}
+
+void MainWindow::initRange(
+        double lower,
+        double upper)
+{
     // Clear zoom stack
     mZoomLevelUndo.clear();
     mZoomLevelRedo.clear();
@@ -1077,61 +1273,87 @@ void MainWindow::on_actionWind_triggered()
     mWindAdjustment = !mWindAdjustment;
     m_ui->actionWind->setChecked(mWindAdjustment);
 
-    updateVelocity();
+    updateDerived();
 
     emit dataChanged();
 }
 
 void MainWindow::on_actionImportGates_triggered()
 {
-    QStringList fileNames = QFileDialog::getOpenFileNames(this, tr("Import Gates"), "", tr("CSV Files (*.csv)"));
+    QStringList fileNames = QFileDialog::getOpenFileNames(this, tr("Import Gates"), "", tr("CSV Files (*.csv *.csv.gz *.gz)"));
 
-    for (int i = 0; i < fileNames.size(); ++i)
+    // Read gate files in parallel
+    const QList< DataPoint > gates =
+            QtConcurrent::blockingMapped< QList< DataPoint > >(fileNames, readGate);
+
+    QStringList failed;
+
+    for (int i = 0; i < gates.size(); ++i)
     {
-        QFile file(fileNames[i]);
-        if (!file.open(QIODevice::ReadOnly))
+        if (!gates[i].hasGeodetic)
         {
-            // TODO: Error message
+            failed.append(QDir::toNativeSeparators(fileNames[i]));
             continue;
         }
 
-        QTextStream in(&file);
+        m_waypoints.append(gates[i]);
+    }
 
-        // skip first 2 rows
-        if (!in.atEnd()) in.readLine();
-        if (!in.atEnd()) in.readLine();
+    emit dataChanged();
 
-        QVector< double > lat, lon, hMSL;
+    if (!failed.isEmpty())
+    {
+        QMessageBox::warning(this, tr("Import Gates"),
+                             tr("Couldn't read a position from these files:\n\n%1")
+                             .arg(failed.join("\n")));
+    }
+}
 
-        while (!in.atEnd())
-        {
-            QString line = in.readLine();
-            QStringList cols = line.split(",");
+DataPoint MainWindow::readGate(
+        const QString &fileName)
+{
+    DataPoint dp;
+    dp.hasGeodetic = false;
 
-            lat.append(cols[1].toDouble());
-            lon.append(cols[2].toDouble());
-            hMSL.append(cols[3].toDouble());
-        }
+    TrackParser parser;
+    if (!parser.open(fileName)) return dp;
+
+    // Keep only the columns we need
+    QVector< double > lat, lon, hMSL;
+    QVector< DataPoint > rows;
+
+    while (!parser.atEnd())
+    {
+        rows.resize(0);
+        parser.readRows(rows, 1000);
 
-        if (lat.size() > 0)
+        for (int i = 0; i < rows.size(); ++i)
         {
-            qSort(lat.begin(), lat.end());
-            qSort(lon.begin(), lon.end());
-            qSort(hMSL.begin(), hMSL.end());
+            lat.append(rows[i].lat);
+            lon.append(rows[i].lon);
+            hMSL.append(rows[i].hMSL);
+        }
+    }
 
-            int mid = lat.size() / 2;
+    if (lat.isEmpty() || parser.failed()) return dp;
 
-            DataPoint dp ;
+    dp.lat  = median(lat);
+    dp.lon  = median(lon);
+    dp.hMSL = median(hMSL);
 
-            dp.lat  = lat[mid];
-            dp.lon  = lon[mid];
-            dp.hMSL = hMSL[mid];
+    dp.hasGeodetic = true;
 
-            m_waypoints.append(dp);
-        }
-    }
+    return dp;
+}
 
-    emit dataChanged();
+double MainWindow::median(
+        QVector< double > &values)
+{
+    // Same element a full sort would put in the middle
+    QVector< double >::iterator mid = values.begin() + values.size() / 2;
+    std::nth_element(values.begin(), mid, values.end());
+
+    return *mid;
 }
 
 void MainWindow::on_actionPreferences_triggered()
@@ -1146,6 +1368,10 @@ void MainWindow::on_actionPreferences_triggered()
     dlg.setMaxLift(m_maxLift);
     dlg.setMaxLD(m_maxLD);
     dlg.setSimulationTime(m_simulationTime);
+    dlg.setResidentTracks(mResidentTracks);
+    dlg.setSlopeWindow(mSlopeWindow);
+    dlg.setExactGeodesic(mExactGeodesic);
+    dlg.setCompactStorage(mCompactStorage);
     dlg.setLineThickness(mLineThickness);
 
     const double factor = (m_units == PlotValue::Metric) ? MPS_TO_KMH : MPS_TO_MPH;
@@ -1164,11 +1390,13 @@ void MainWindow::on_actionPreferences_triggered()
 
     if (dlg.exec() == QDialog::Accepted)
     {
+        bool changed = false;
+
         if (m_units != dlg.units())
         {
             m_units = dlg.units();
 
-            emit dataChanged();
+            changed = true;
         }
 
         if (m_mass != dlg.mass() ||
@@ -1177,9 +1405,7 @@ void MainWindow::on_actionPreferences_triggered()
             m_mass = dlg.mass();
             m_planformArea = dlg.planformArea();
 
-            initAerodynamics();
-
-            emit dataChanged();
+            changed = true;
         }
 
         if (m_minDrag != dlg.minDrag() ||
@@ -1192,11 +1418,38 @@ void MainWindow::on_actionPreferences_triggered()
             m_maxLift = dlg.maxLift();
             m_maxLD = dlg.maxLD();
 
-            emit dataChanged();
+            changed = true;
         }
 
         m_simulationTime = dlg.simulationTime();
 
+        if (mResidentTracks != dlg.residentTracks())
+        {
+            mResidentTracks = dlg.residentTracks();
+            mTrackCatalog->setLimit(mResidentTracks);
+        }
+
+        if (mExactGeodesic != dlg.exactGeodesic() ||
+            mSlopeWindow != dlg.slopeWindow())
+        {
+            mExactGeodesic = dlg.exactGeodesic();
+            mSlopeWindow = dlg.slopeWindow();
+
+            changed = true;
+        }
+
+        if (mCompactStorage != dlg.compactStorage())
+        {
+            mCompactStorage = dlg.compactStorage();
+            m_data.setCompact(mCompactStorage);
+            m_optimal.setCompact(mCompactStorage);
+            ++mOptimalRevision;
+            shareTrack();
+            mTrackCatalog->setCompact(mCompactStorage);
+
+            changed = true;
+        }
+
         bool plotChanged = false;
         for (int i = 0; i < plotArea()->yaLast; ++i)
         {
@@ -1241,7 +1494,7 @@ void MainWindow::on_actionPreferences_triggered()
 
         if (plotChanged)
         {
-            emit dataChanged();
+            changed = true;
         }
 
         if (mWindE != -dlg.windSpeed() * sin(dlg.windDirection() / 180 * PI) / factor ||
@@ -1250,7 +1503,7 @@ void MainWindow::on_actionPreferences_triggered()
             mWindE = -dlg.windSpeed() * sin(dlg.windDirection() / 180 * PI) / factor;
             mWindN = -dlg.windSpeed() * cos(dlg.windDirection() / 180 * PI) / factor;
 
-            emit dataChanged();
+            changed = true;
         }
 
         if (mGroundReference != dlg.groundReference() ||
@@ -1259,7 +1512,13 @@ void MainWindow::on_actionPreferences_triggered()
             mGroundReference = dlg.groundReference();
             mFixedReference = dlg.fixedReference();
 
-            initAltitude();
+            changed = true;
+        }
+
+        // Recompute what depends on the new settings, then update views once
+        if (changed)
+        {
+            updateDerived();
 
             emit dataChanged();
         }
@@ -1346,25 +1605,26 @@ void MainWindow::on_actionExportKML_triggered()
         double lower = rangeLower();
         double upper = rangeUpper();
 
+        // Rows within the range
+        const int start = findIndexBelowT(lower) + 1;
+        const int end = findIndexAboveT(upper);
+
         bool first = true;
-        for (int i = 0; i < dataSize(); ++i)
+        for (int i = start; i < end; ++i)
         {
-            const DataPoint &dp = dataPoint(i);
+            const DataPoint dp = dataPoint(i);
 
-            if (lower <= dp.t && dp.t <= upper)
+            if (first)
+            {
+                stream << "        ";
+                first = false;
+            }
+            else
             {
-                if (first)
-                {
-                    stream << "        ";
-                    first = false;
-                }
-                else
-                {
-                    stream << " ";
-                }
-
-                stream << QString("%1,%2,%3").arg(dp.lon, 0, 'f', 7).arg(dp.lat, 0, 'f', 7).arg(dp.hMSL, 0, 'f', 3);
+                stream << " ";
             }
+
+            stream << QString("%1,%2,%3").arg(dp.lon, 0, 'f', 7).arg(dp.lat, 0, 'f', 7).arg(dp.hMSL, 0, 'f', 3);
         }
 
         if (!first)
@@ -1421,20 +1681,21 @@ void MainWindow::on_actionExportPlot_triggered()
         double lower = rangeLower();
         double upper = rangeUpper();
 
-        for (int i = 0; i < dataSize(); ++i)
+        // Rows within the range
+        const int start = findIndexBelowT(lower) + 1;
+        const int end = findIndexAboveT(upper);
+
+        for (int i = start; i < end; ++i)
         {
-            const DataPoint &dp = dataPoint(i);
+            const DataPoint dp = dataPoint(i);
 
-            if (lower <= dp.t && dp.t <= upper)
+            stream << m_ui->plotArea->xValue()->value(dp, m_units);
+            for (int j = 0; j < DataPlot::yaLast; ++j)
             {
-                stream << m_ui->plotArea->xValue()->value(dp, m_units);
-                for (int j = 0; j < DataPlot::yaLast; ++j)
-                {
-                    if (!m_ui->plotArea->yValue(j)->visible()) continue;
-                    stream << QString(",%1").arg(m_ui->plotArea->yValue(j)->value(dp, m_units), 0, 'f');
-                }
-                stream << endl;
+                if (!m_ui->plotArea->yValue(j)->visible()) continue;
+                stream << QString(",%1").arg(m_ui->plotArea->yValue(j)->value(dp, m_units), 0, 'f');
             }
+            stream << endl;
         }
     }
 }
@@ -1474,40 +1735,43 @@ void MainWindow::on_actionExportTrack_triggered()
         double lower = rangeLower();
         double upper = rangeUpper();
 
-        for (int i = 0; i < dataSize(); ++i)
+        // Rows within the range
+        const int start = findIndexBelowT(lower) + 1;
+        const int end = findIndexAboveT(upper);
+
+        for (int i = start; i < end; ++i)
         {
-            const DataPoint &dp = dataPoint(i);
+            const DataPoint dp = dataPoint(i);
 
-            if (lower <= dp.t && dp.t <= upper)
-            {
-                stream << dp.dateTime.date().toString(Qt::ISODate) << "T";
-                stream << dp.dateTime.time().toString(Qt::ISODate) << ".";
-                stream << QString("%1").arg(dp.dateTime.time().msec(), 3, 10, QChar('0')) << "Z,";
+            const QDateTime dateTime = DataPoint::dateTime(dp);
 
-                stream << QString::number(dp.lat, 'f', 7) << ",";
-                stream << QString::number(dp.lon, 'f', 7) << ",";
-                stream << QString::number(dp.hMSL, 'f', 3) << ",";
+            stream << dateTime.date().toString(Qt::ISODate) << "T";
+            stream << dateTime.time().toString(Qt::ISODate) << ".";
+            stream << QString("%1").arg(dateTime.time().msec(), 3, 10, QChar('0')) << "Z,";
 
-                stream << QString::number(dp.velN, 'f', 2) << ",";
-                stream << QString::number(dp.velE, 'f', 2) << ",";
-                stream << QString::number(dp.velD, 'f', 2) << ",";
+            stream << QString::number(dp.lat, 'f', 7) << ",";
+            stream << QString::number(dp.lon, 'f', 7) << ",";
+            stream << QString::number(dp.hMSL, 'f', 3) << ",";
 
-                stream << QString::number(dp.hAcc, 'f', 3) << ",";
-                stream << QString::number(dp.vAcc, 'f', 3) << ",";
-                stream << QString::number(dp.sAcc, 'f', 2) << ",";
+            stream << QString::number(dp.velN, 'f', 2) << ",";
+            stream << QString::number(dp.velE, 'f', 2) << ",";
+            stream << QString::number(dp.velD, 'f', 2) << ",";
 
-                // Get adjusted heading
-                double heading = dp.heading;
-                while (heading <  0)   heading += 360;
-                while (heading >= 360) heading -= 360;
+            stream << QString::number(dp.hAcc, 'f', 3) << ",";
+            stream << QString::number(dp.vAcc, 'f', 3) << ",";
+            stream << QString::number(dp.sAcc, 'f', 2) << ",";
 
-                stream << QString::number(heading, 'f', 5) << ",";
-                stream << QString::number(dp.cAcc, 'f', 5) << ",";
+            // Get adjusted heading
+            double heading = dp.heading;
+            while (heading <  0)   heading += 360;
+            while (heading >= 360) heading -= 360;
 
-                stream << ",";  // gpsFix
+            stream << QString::number(heading, 'f', 5) << ",";
+            stream << QString::number(dp.cAcc, 'f', 5) << ",";
 
-                stream << QString::number(dp.numSV) << endl;
-            }
+            stream << ",";  // gpsFix
+
+            stream << QString::number(dp.numSV) << endl;
         }
     }
 }
@@ -1519,8 +1783,8 @@ void MainWindow::setRange(
     mZoomLevelUndo.push(mZoomLevel);
     mZoomLevelRedo.clear();
 
-    mZoomLevel.rangeLower = qMin(lower, upper);
-    mZoomLevel.rangeUpper = qMax(lower, upper);
+    mZoomLevel.rangeLower = qMin(lower, upper) + m_data.offset(TrackStore::T);
+    mZoomLevel.rangeUpper = qMax(lower, upper) + m_data.offset(TrackStore::T);
 
     emit dataChanged();
 
@@ -1541,37 +1805,8 @@ void MainWindow::setZero(
 {
     if (m_data.isEmpty()) return;
 
-    DataPoint dp0 = interpolateDataT(t);
-
-    for (int i = 0; i < m_data.size(); ++i)
-    {
-        DataPoint &dp = m_data[i];
-
-        dp.t -= dp0.t;
-        dp.x -= dp0.x;
-        dp.y -= dp0.y;
-
-        dp.dist2D -= dp0.dist2D;
-        dp.dist3D -= dp0.dist3D;
-    }
-
-    mMarkStart -= dp0.t;
-    mMarkEnd -= dp0.t;
-
-    QVector< ZoomLevel >::iterator p;
-    for (p = mZoomLevelUndo.begin(); p != mZoomLevelUndo.end(); ++p)
-    {
-        p->rangeLower -= dp0.t;
-        p->rangeUpper -= dp0.t;
-    }
-    for (p = mZoomLevelRedo.begin(); p != mZoomLevelRedo.end(); ++p)
-    {
-        p->rangeLower -= dp0.t;
-        p->rangeUpper -= dp0.t;
-    }
-
-    mZoomLevel.rangeLower -= dp0.t;
-    mZoomLevel.rangeUpper -= dp0.t;
+    moveZero(t);
+    mHasZero = true;
 
     emit dataChanged();
 
@@ -1584,12 +1819,7 @@ void MainWindow::setGround(
     if (m_data.isEmpty()) return;
 
     DataPoint dp0 = interpolateDataT(t);
-
-    for (int i = 0; i < m_data.size(); ++i)
-    {
-        DataPoint &dp = m_data[i];
-        dp.z -= dp0.z;
-    }
+    m_data.setOffset(TrackStore::Z, m_data.offset(TrackStore::Z) + dp0.z);
 
     emit dataChanged();
 
@@ -1602,12 +1832,7 @@ void MainWindow::setCourse(
     if (m_data.isEmpty()) return;
 
     DataPoint dp0 = interpolateDataT(t);
-
-    for (int i = 0; i < m_data.size(); ++i)
-    {
-        DataPoint &dp = m_data[i];
-        dp.theta -= dp0.theta;
-    }
+    m_data.setOffset(TrackStore::Theta, m_data.offset(TrackStore::Theta) + dp0.theta);
 
     emit dataChanged();
 
@@ -1688,7 +1913,7 @@ void MainWindow::setWind(
     mWindE = windE;
     mWindN = windN;
 
-    updateVelocity();
+    updateDerived();
 
     emit dataChanged();
 }
@@ -1767,6 +1992,24 @@ void MainWindow::closeReference()
 void MainWindow::setOptimal(
         const QVector< DataPoint > &result)
 {
-    m_optimal = result;
+    // Slopes of the simulated track
+    static const DerivativeEngine::Value values[] = {
+        DataPoint::diveAngle,
+        DataPoint::totalSpeed
+    };
+
+    static double DataPoint::*const slopes[] = {
+        &DataPoint::curv,
+        &DataPoint::accel
+    };
+
+    QVector< DataPoint > rows = result;
+    DerivativeEngine(mSlopeWindow).update(rows, 0, rows.size(),
+                                          values, slopes, 2);
+
+    // Stored like the track, so it takes no more memory than the track does
+    m_optimal = TrackStore(rows, mCompactStorage);
+    ++mOptimalRevision;
+
     emit dataChanged();
 }
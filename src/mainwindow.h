@@ -9,12 +9,19 @@
 #include "dataplot.h"
 #include "datapoint.h"
 #include "dataview.h"
+#include "trackprocessor.h"
+#include "trackstore.h"
 
 class MapView;
 class QCPRange;
 class QCustomPlot;
+class QFileSystemWatcher;
+class QProgressDialog;
+class QThread;
 class ScoringMethod;
 class ScoringView;
+class TrackCatalog;
+class TrackImporter;
 
 namespace Ui {
 class MainWindow;
@@ -48,15 +55,17 @@ public:
     explicit MainWindow(QWidget *parent = 0);
     ~MainWindow();
 
-    const QVector< DataPoint > &data() const { return m_data; }
+    // Track as shown, relative to the zero point, ground and course
+    const TrackStore &track() const { return m_data; }
+
     int dataSize() const { return m_data.size(); }
-    const DataPoint &dataPoint(int i) const { return m_data[i]; }
+    DataPoint dataPoint(int i) const { return m_data.at(i); }
 
     PlotValue::Units units() const { return m_units; }
 
     void setRange(double lower, double upper);
-    double rangeLower() const { return mZoomLevel.rangeLower; }
-    double rangeUpper() const { return mZoomLevel.rangeUpper; }
+    double rangeLower() const { return mZoomLevel.rangeLower - m_data.offset(TrackStore::T); }
+    double rangeUpper() const { return mZoomLevel.rangeUpper - m_data.offset(TrackStore::T); }
 
     void setZero(double t);
     void setGround(double t);
@@ -65,27 +74,38 @@ public:
     void setTool(Tool tool);
     Tool tool() const { return mTool; }
 
-    double markStart() const { return mMarkStart; }
-    double markEnd() const { return mMarkEnd; }
+    double markStart() const { return mMarkStart - m_data.offset(TrackStore::T); }
+    double markEnd() const { return mMarkEnd - m_data.offset(TrackStore::T); }
     bool markActive() const { return mMarkActive; }
 
+    // Point at the end of the mark, where the views draw their cursors
+    DataPoint markPoint() { return interpolateDataT(markEnd()); }
+
     void setRotation(double rotation);
     double rotation() const { return m_viewDataRotation; }
 
     int waypointSize() const { return m_waypoints.size(); }
     const DataPoint &waypoint(int i) const { return m_waypoints[i]; }
 
-    static double getDistance(const DataPoint &dp1, const DataPoint &dp2);
-    static double getBearing(const DataPoint &dp1, const DataPoint &dp2);
+    static double getDistance(const DataPoint &dp1, const DataPoint &dp2)
+    {
+        return TrackProcessor::getDistance(dp1, dp2);
+    }
+    static double getBearing(const DataPoint &dp1, const DataPoint &dp2)
+    {
+        return TrackProcessor::getBearing(dp1, dp2);
+    }
 
     void setMark(double start, double end);
     void setMark(double mark);
     void clearMark();
 
     DataPoint interpolateDataT(double t);
+    DataPoint nearestDataT(double t) const;
 
     int findIndexBelowT(double t);
     int findIndexAboveT(double t);
+    void bracketT(double t, int &below, int &above, double &fraction) const;
 
     void setWindowMode(WindowMode mode);
     WindowMode windowMode() const { return mWindowMode; }
@@ -104,14 +124,18 @@ public:
     void setMaxLift(double maxLift);
     void setMaxLD(double maxLD);    
 
-    const QVector< DataPoint > &optimal() const { return m_optimal; }
+    const TrackStore &optimal() const { return m_optimal; }
+    quint32 optimalRevision() const { return mOptimalRevision; }
     void setOptimal(const QVector< DataPoint > &result);
 
     int optimalSize() const { return m_optimal.size(); }
-    const DataPoint &optimalPoint(int i) const { return m_optimal[i]; }
+    DataPoint optimalPoint(int i) const { return m_optimal.at(i); }
 
     DataPlot *plotArea() const;
 
+    // Current settings, with the reference of the track shown
+    TrackProcessor trackProcessor() const;
+
     void setLineThickness(double width);
     double lineThickness() const { return mLineThickness; }
 
@@ -130,11 +154,16 @@ public:
     bool updateReference(double lat, double lon);
     void closeReference();
 
+    TrackCatalog *trackCatalog() const { return mTrackCatalog; }
+    const QString &trackName() const { return mTrackName; }
+
 protected:
     void closeEvent(QCloseEvent *event);
 
 private slots:
     void on_actionImport_triggered();
+    void on_actionImportFolder_triggered();
+    void on_actionFollowTrack_triggered();
 
     void on_actionElevation_triggered();
     void on_actionVerticalSpeed_triggered();
@@ -186,8 +215,14 @@ private:
     } ZoomLevel;
 
     Ui::MainWindow       *m_ui;
-    QVector< DataPoint >  m_data;
-    QVector< DataPoint >  m_optimal;
+    TrackStore            m_data;
+    TrackStore            m_optimal;
+    quint32               mOptimalRevision;
+
+    // The zero point, ground and course set with the tools are column
+    // offsets of m_data, so setting them never rewrites the track. Times
+    // below are stored without the offset.
+    bool                  mHasZero;
 
     double                mMarkStart;
     double                mMarkEnd;
@@ -234,6 +269,26 @@ private:
     GroundReference       mGroundReference;
     double                mFixedReference;
 
+    bool                  mExactGeodesic;
+    bool                  mCompactStorage;
+    double                mSlopeWindow;
+
+    QThread              *mImportThread;
+    TrackImporter        *mImporter;
+    QProgressDialog      *mImportProgress;
+    int                   mImportId;
+
+    TrackCatalog         *mTrackCatalog;
+    int                   mResidentTracks;
+    QString               mTrackName;
+    QString               mPendingTrack;
+    qint64                mTimeReference;
+    DataPoint             mOrigin;
+    TrackProcessor        mProcessor;
+
+    QFileSystemWatcher   *mFollowWatcher;
+    qint64                mFollowPosition;
+
     void writeSettings();
     void readSettings();
 
@@ -245,17 +300,26 @@ private:
     void initLiftDragView();
     void initOrthoView();
     void initPlaybackView();
+    void initTrackView();
 
     void initSingleView(const QString &title, const QString &objectName,
                         QAction *actionShow, DataView::Direction direction);
 
-    void initAltitude();
-    void updateVelocity();
-    void initAerodynamics();
+    void shareTrack();
 
-    double getSlope(const int center, double (*value)(const DataPoint &)) const;
+    void updateDerived();
+
+    void moveZero(double t);
+    void clearOffsets();
 
     void initRange();
+    void initRange(double lower, double upper);
+
+    void importFiles(const QStringList &fileNames);
+
+    static DataPoint readGate(const QString &fileName);
+    static double median(QVector< double > &values);
+    void initFollow();
 
     void updateBottomActions();
     void updateLeftActions();
@@ -266,12 +330,27 @@ signals:
     void cursorChanged();
     void aeroChanged();
     void rotationChanged(double rotation);
+    void importRequested(int id, const QString &fileName,
+                         const TrackProcessor &processor, bool automaticGround);
+    void cacheRequested(int id, const TrackStore &track,
+                        const TrackProcessor &processor);
 
 public slots:
     void importFile(QString fileName);
+    void selectTrack(const QString &fileName);
 
 private slots:
     void setScoringVisible(bool visible);
+
+    void importStarted(int id, const TrackProcessor &processor);
+    void importChunk(int id, const QVector< DataPoint > &data, int progress);
+    void importTrack(int id, const TrackStore &track);
+    void importProgress(int id, int progress);
+    void importFinished(int id, int status);
+    void cancelImport();
+
+    void trackLoaded(const QString &fileName);
+    void followTrack(const QString &fileName);
 };
 
 #endif // MAINWINDOW_H
@@ -76,26 +76,29 @@ void MapView::mouseMoveEvent(
         double resultTime;
         double resultDistance = std::numeric_limits<double>::max();
 
-        for (int i = 0; i + 1 < mMainWindow->dataSize(); ++i)
-        {
-            const DataPoint &dp1 = mMainWindow->dataPoint(i);
-            const DataPoint &dp2 = mMainWindow->dataPoint(i + 1);
+        const TrackStore &track = mMainWindow->track();
+
+        const TrackStore::Span t = track.column(TrackStore::T);
+        const TrackStore::Span lat = track.column(TrackStore::Lat);
+        const TrackStore::Span lon = track.column(TrackStore::Lon);
 
-            if (lower <= dp1.t && dp1.t <= upper &&
-                lower <= dp2.t && dp2.t <= upper)
+        for (int i = 0; i + 1 < track.size(); ++i)
+        {
+            if (lower <= t[i] && t[i] <= upper &&
+                lower <= t[i + 1] && t[i + 1] <= upper)
             {
-                QPointF pt1 = QPointF(width() * (dp1.lon - lonMin) / (lonMax - lonMin),
-                                      height() * (latMax - dp1.lat) / (latMax - latMin));
-                QPointF pt2 = QPointF(width() * (dp2.lon - lonMin) / (lonMax - lonMin),
-                                      height() * (latMax - dp2.lat) / (latMax - latMin));
+                QPointF pt1 = QPointF(width() * (lon[i] - lonMin) / (lonMax - lonMin),
+                                      height() * (latMax - lat[i]) / (latMax - latMin));
+                QPointF pt2 = QPointF(width() * (lon[i + 1] - lonMin) / (lonMax - lonMin),
+                                      height() * (latMax - lat[i + 1]) / (latMax - latMin));
 
                 double mu;
                 double dist = sqrt(distSqrToLine(pt1, pt2, event->pos(), mu));
 
                 if (dist < resultDistance)
                 {
-                    double t1 = dp1.t;
-                    double t2 = dp2.t;
+                    double t1 = t[i];
+                    double t2 = t[i + 1];
 
                     resultTime = t1 + mu * (t2 - t1);
                     resultDistance = dist;
@@ -148,22 +151,25 @@ void MapView::initView()
     double xMin, xMax;
     double yMin, yMax;
 
-    for (int i = 0; i < mMainWindow->dataSize(); ++i)
-    {
-        const DataPoint &dp = mMainWindow->dataPoint(i);
+    const TrackStore &track = mMainWindow->track();
+
+    const TrackStore::Span lat = track.column(TrackStore::Lat);
+    const TrackStore::Span lon = track.column(TrackStore::Lon);
 
+    for (int i = 0; i < track.size(); ++i)
+    {
         if (i == 0)
         {
-            xMin = xMax = dp.lon;
-            yMin = yMax = dp.lat;
+            xMin = xMax = lon[i];
+            yMin = yMax = lat[i];
         }
         else
         {
-            if (dp.lon < xMin) xMin = dp.lon;
-            if (dp.lon > xMax) xMax = dp.lon;
+            if (lon[i] < xMin) xMin = lon[i];
+            if (lon[i] > xMax) xMax = lon[i];
 
-            if (dp.lat < yMin) yMin = dp.lat;
-            if (dp.lat > yMax) yMax = dp.lat;
+            if (lat[i] < yMin) yMin = lat[i];
+            if (lat[i] > yMax) yMax = lat[i];
         }
     }
 
@@ -195,32 +201,37 @@ void MapView::updateView()
     QString js = QString("var path = poly.getPath();") +
                  QString("while (path.length > 0) { path.pop(); }");
 
+    const TrackStore &track = mMainWindow->track();
+
+    const TrackStore::Span t = track.column(TrackStore::T);
+    const TrackStore::Span lat = track.column(TrackStore::Lat);
+    const TrackStore::Span lon = track.column(TrackStore::Lon);
+    const TrackStore::Span dist2D = track.column(TrackStore::Dist2D);
+
     double distPrev;
-    for (int i = 0; i < mMainWindow->dataSize(); ++i)
+    for (int i = 0; i < track.size(); ++i)
     {
-        const DataPoint &dp = mMainWindow->dataPoint(i);
-
-        if (i > 0 && dp.dist2D - distPrev < threshold) continue;
-        distPrev = dp.dist2D;
+        if (i > 0 && dist2D[i] - distPrev < threshold) continue;
+        distPrev = dist2D[i];
 
-        if (lower <= dp.t && dp.t <= upper)
+        if (lower <= t[i] && t[i] <= upper)
         {
             if (first)
             {
-                xMin = xMax = dp.lon;
-                yMin = yMax = dp.lat;
+                xMin = xMax = lon[i];
+                yMin = yMax = lat[i];
                 first = false;
             }
             else
             {
-                if (dp.lon < xMin) xMin = dp.lon;
-                if (dp.lon > xMax) xMax = dp.lon;
+                if (lon[i] < xMin) xMin = lon[i];
+                if (lon[i] > xMax) xMax = lon[i];
 
-                if (dp.lat < yMin) yMin = dp.lat;
-                if (dp.lat > yMax) yMax = dp.lat;
+                if (lat[i] < yMin) yMin = lat[i];
+                if (lat[i] > yMax) yMax = lat[i];
             }
 
-            js += QString("path.push(new google.maps.LatLng(%1, %2));").arg(dp.lat, 0, 'f').arg(dp.lon, 0, 'f');
+            js += QString("path.push(new google.maps.LatLng(%1, %2));").arg(lat[i], 0, 'f').arg(lon[i], 0, 'f');
         }
     }
 
@@ -229,7 +240,7 @@ void MapView::updateView()
     if (mMainWindow->markActive())
     {
         // Add marker to map
-        const DataPoint &dpEnd = mMainWindow->interpolateDataT(mMainWindow->markEnd());
+        const DataPoint dpEnd = mMainWindow->markPoint();
 
         js = QString("marker.setPosition(new google.maps.LatLng(%1, %2));").arg(dpEnd.lat, 0, 'f').arg(dpEnd.lon, 0, 'f') +
              QString("marker.setVisible(true);");
@@ -0,0 +1,316 @@
+#include "minmaxpyramid.h"
+
+#include <QtNumeric>
+
+MinMaxPyramid::MinMaxPyramid()
+{
+
+}
+
+void MinMaxPyramid::clear()
+{
+    mValues.clear();
+    mMin.clear();
+    mMax.clear();
+}
+
+void MinMaxPyramid::setValues(
+        const QVector< double > &values)
+{
+    clear();
+    mValues = values;
+    build(0);
+}
+
+void MinMaxPyramid::setValues(
+        int first,
+        const QVector< double > &values)
+{
+    first = qBound(0, first, mValues.size());
+
+    if (first == 0)
+    {
+        mValues = values;
+    }
+    else
+    {
+        mValues.resize(first);
+        mValues += values;
+    }
+
+    build(first);
+}
+
+void MinMaxPyramid::build(
+        int first)
+{
+    const int size = mValues.size();
+    const int run = 1 << FirstLevel;
+
+    if (size <= run)
+    {
+        mMin.clear();
+        mMax.clear();
+        return;
+    }
+
+    if (mMin.isEmpty())
+    {
+        mMin.resize(1);
+        mMax.resize(1);
+    }
+
+    // Finest level from the values themselves, from the run holding the
+    // first changed row
+    QVector< int > &minRows = mMin[0];
+    QVector< int > &maxRows = mMax[0];
+
+    int changed = qMin(first / run, minRows.size());
+
+    minRows.resize((size + run - 1) / run);
+    maxRows.resize(minRows.size());
+
+    for (int r = changed; r < minRows.size(); ++r)
+    {
+        const int begin = r * run;
+        const int end = qMin(begin + run, size);
+
+        int iMin = begin, iMax = begin;
+        for (int i = begin + 1; i < end; ++i)
+        {
+            iMin = lower(iMin, i);
+            iMax = upper(iMax, i);
+        }
+
+        minRows[r] = iMin;
+        maxRows[r] = iMax;
+    }
+
+    // Each coarser level from pairs of runs of the one below, up to a
+    // single run
+    int level = 1;
+    for (; mMin[level - 1].size() > 1; ++level)
+    {
+        if (level == mMin.size())
+        {
+            mMin.append(QVector< int >());
+            mMax.append(QVector< int >());
+        }
+
+        const QVector< int > &prevMin = mMin[level - 1];
+        const QVector< int > &prevMax = mMax[level - 1];
+
+        QVector< int > &nextMin = mMin[level];
+        QVector< int > &nextMax = mMax[level];
+
+        changed = qMin(changed / 2, nextMin.size());
+
+        nextMin.resize((prevMin.size() + 1) / 2);
+        nextMax.resize(nextMin.size());
+
+        for (int r = changed; r < nextMin.size(); ++r)
+        {
+            const int a = 2 * r;
+            const int b = qMin(a + 1, prevMin.size() - 1);
+
+            nextMin[r] = lower(prevMin[a], prevMin[b]);
+            nextMax[r] = upper(prevMax[a], prevMax[b]);
+        }
+    }
+
+    // Levels above that are left from a longer series
+    mMin.resize(level);
+    mMax.resize(level);
+}
+
+void MinMaxPyramid::decimate(
+        int begin,
+        int end,
+        int maxPoints,
+        QVector< int > &rows) const
+{
+    rows.clear();
+
+    begin = qMax(begin, 0);
+    end = qMin(end, mValues.size());
+
+    if (end <= begin) return;
+
+    if (end - begin <= maxPoints || mMin.isEmpty())
+    {
+        rows.reserve(end - begin);
+        for (int i = begin; i < end; ++i)
+        {
+            rows.append(i);
+        }
+        return;
+    }
+
+    // Finest level with no more runs than half the points
+    const int runs = qMax(1, maxPoints / 2);
+
+    int level = FirstLevel;
+    while (((end - begin) >> level) > runs
+           && level - FirstLevel + 1 < mMin.size())
+    {
+        ++level;
+    }
+
+    const QVector< int > &minRows = mMin[level - FirstLevel];
+    const QVector< int > &maxRows = mMax[level - FirstLevel];
+    const int run = 1 << level;
+
+    // Whole runs inside the range
+    const int first = (begin + run - 1) / run;
+    const int last = end / run;
+
+    rows.reserve(2 * (last - first) + 4);
+
+    if (first >= last)
+    {
+        scan(begin, end, rows);
+        return;
+    }
+
+    // Partial runs at either end are scanned directly
+    scan(begin, first * run, rows);
+
+    for (int r = first; r < last; ++r)
+    {
+        append(minRows[r], maxRows[r], rows);
+    }
+
+    scan(last * run, end, rows);
+}
+
+bool MinMaxPyramid::range(
+        int begin,
+        int end,
+        double &min,
+        double &max) const
+{
+    begin = qMax(begin, 0);
+    end = qMin(end, mValues.size());
+
+    bool found = false;
+    const int run = 1 << FirstLevel;
+
+    // Whole runs of the finest level inside the range
+    int first = (begin + run - 1) / run;
+    int last = end / run;
+
+    if (mMin.isEmpty() || first >= last)
+    {
+        for (int i = begin; i < end; ++i)
+        {
+            include(i, found, min, max);
+        }
+        return found;
+    }
+
+    // Rows of partial runs at either end
+    for (int i = begin; i < first * run; ++i)
+    {
+        include(i, found, min, max);
+    }
+
+    for (int i = last * run; i < end; ++i)
+    {
+        include(i, found, min, max);
+    }
+
+    // Runs not covered by a run of the next level, then up a level
+    for (int level = 0; first < last; ++level)
+    {
+        const QVector< int > &minRows = mMin[level];
+        const QVector< int > &maxRows = mMax[level];
+
+        if (first & 1)
+        {
+            include(minRows[first], found, min, max);
+            include(maxRows[first], found, min, max);
+            ++first;
+        }
+
+        if (last & 1)
+        {
+            --last;
+            include(minRows[last], found, min, max);
+            include(maxRows[last], found, min, max);
+        }
+
+        first /= 2;
+        last /= 2;
+    }
+
+    return found;
+}
+
+void MinMaxPyramid::include(
+        int i,
+        bool &found,
+        double &min,
+        double &max) const
+{
+    const double value = mValues[i];
+    if (qIsNaN(value)) return;
+
+    if (!found)
+    {
+        min = max = value;
+        found = true;
+    }
+    else
+    {
+        if (value < min) min = value;
+        if (value > max) max = value;
+    }
+}
+
+int MinMaxPyramid::lower(
+        int a,
+        int b) const
+{
+    return (qIsNaN(mValues[a]) || mValues[b] < mValues[a]) ? b : a;
+}
+
+int MinMaxPyramid::upper(
+        int a,
+        int b) const
+{
+    return (qIsNaN(mValues[a]) || mValues[b] > mValues[a]) ? b : a;
+}
+
+void MinMaxPyramid::scan(
+        int begin,
+        int end,
+        QVector< int > &rows) const
+{
+    if (end <= begin) return;
+
+    int iMin = begin, iMax = begin;
+    for (int i = begin + 1; i < end; ++i)
+    {
+        iMin = lower(iMin, i);
+        iMax = upper(iMax, i);
+    }
+
+    append(iMin, iMax, rows);
+}
+
+void MinMaxPyramid::append(
+        int a,
+        int b,
+        QVector< int > &rows)
+{
+    // In order along the series, once if they are the same row
+    if (a == b)
+    {
+        rows.append(a);
+    }
+    else
+    {
+        rows.append(qMin(a, b));
+        rows.append(qMax(a, b));
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef MINMAXPYRAMID_H
+#define MINMAXPYRAMID_H
+
+#include <QVector>
+
+// Rows holding the smallest and largest value of each run of 2^k rows, for
+// every k from FirstLevel up. A long series can then be drawn from the
+// extremes of runs a pixel or so wide, which leaves its envelope unchanged
+// however many rows each run covers. The same runs give the extremes of any
+// range of rows from O(log n) of them. NaN values are only chosen when a run
+// has nothing else.
+
+class MinMaxPyramid
+{
+public:
+    MinMaxPyramid();
+
+    void setValues(const QVector< double > &values);
+    void clear();
+
+    // Replaces rows from first onwards, rebuilding only the runs that hold
+    // them, so rows added to the end cost O(added + log n)
+    void setValues(int first, const QVector< double > &values);
+
+    const QVector< double > &values() const { return mValues; }
+    bool isEmpty() const { return mValues.isEmpty(); }
+
+    // Rows [begin, end) reduced to at most about maxPoints rows, keeping the
+    // minimum and maximum of each run in order. All rows are kept when there
+    // are no more than maxPoints.
+    void decimate(int begin, int end, int maxPoints, QVector< int > &rows) const;
+
+    // Smallest and largest value of rows [begin, end), ignoring NaN. Returns
+    // false if there are none.
+    bool range(int begin, int end, double &min, double &max) const;
+
+private:
+    // Runs of the finest level are 2^FirstLevel rows long
+    enum { FirstLevel = 2 };
+
+    QVector< double >          mValues;
+    QVector< QVector< int > >  mMin;
+    QVector< QVector< int > >  mMax;
+
+    // Runs holding rows from first onwards
+    void build(int first);
+
+    int lower(int a, int b) const;
+    int upper(int a, int b) const;
+
+    void scan(int begin, int end, QVector< int > &rows) const;
+    void include(int i, bool &found, double &min, double &max) const;
+    static void append(int a, int b, QVector< int > &rows);
+};
+
+#endif // MINMAXPYRAMID_H
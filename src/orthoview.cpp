@@ -147,13 +147,8 @@ void OrthoView::endTimer()
 void OrthoView::updateView()
 {
     // Calculate camera vectors
-    QVector3D up(-sin(m_elevation) * cos(m_azimuth),
-                 -sin(m_elevation) * sin(m_azimuth),
-                  cos(m_elevation));
-    QVector3D bk(cos(m_elevation) * cos(m_azimuth),
-                 cos(m_elevation) * sin(m_azimuth),
-                 sin(m_elevation));
-    QVector3D rt = QVector3D::crossProduct(up, bk);
+    QVector3D up, bk, rt;
+    cameraVectors(up, bk, rt);
 
     double lower = mMainWindow->rangeLower();
     double upper = mMainWindow->rangeUpper();
@@ -168,62 +163,62 @@ void OrthoView::updateView()
     double vMin, vMax;
     double wMin, wMax;
 
-    bool first = true;
+    // Rows within the range
+    const int start = mMainWindow->findIndexBelowT(lower) + 1;
+    const int end = mMainWindow->findIndexAboveT(upper);
+
+    const TrackStore &track = mMainWindow->track();
+    const TrackStore::Span spanT = track.column(TrackStore::T);
+    const TrackStore::Span spanX = track.column(TrackStore::X);
+    const TrackStore::Span spanY = track.column(TrackStore::Y);
+    const TrackStore::Span spanZ = track.column(TrackStore::Z);
 
-    for (int i = 0; i < mMainWindow->dataSize(); ++i)
+    bool first = true;
+    for (int i = start; i < end; ++i)
     {
-        const DataPoint &dp = mMainWindow->dataPoint(i);
+        t.append(spanT[i]);
 
-        if (lower <= dp.t && dp.t <= upper)
-        {
-            t.append(dp.t);
+        const double px = spanX[i];
+        const double py = spanY[i];
+        const double pz = spanZ[i];
 
-            QVector3D cur;
-            if (mMainWindow->units() == PlotValue::Metric)
-            {
-                cur = QVector3D(dp.x, dp.y, dp.z);
-            }
-            else
-            {
-                cur = QVector3D(dp.x, dp.y, dp.z) * METERS_TO_FEET;
-            }
+        const QVector3D cur = viewPosition(px, py, pz);
 
-            x.append(QVector3D::dotProduct(cur, rt));
-            y.append(QVector3D::dotProduct(cur, up));
-            z.append(QVector3D::dotProduct(cur, bk));
+        x.append(QVector3D::dotProduct(cur, rt));
+        y.append(QVector3D::dotProduct(cur, up));
+        z.append(QVector3D::dotProduct(cur, bk));
 
-            if (first)
-            {
-                xMin = xMax = x.back();
-                yMin = yMax = y.back();
-                zMin = zMax = z.back();
+        if (first)
+        {
+            xMin = xMax = x.back();
+            yMin = yMax = y.back();
+            zMin = zMax = z.back();
 
-                uMin = uMax = dp.x;
-                vMin = vMax = dp.y;
-                wMin = wMax = dp.z;
+            uMin = uMax = px;
+            vMin = vMax = py;
+            wMin = wMax = pz;
 
-                first = false;
-            }
-            else
-            {
-                if (x.back() < xMin) xMin = x.back();
-                if (x.back() > xMax) xMax = x.back();
+            first = false;
+        }
+        else
+        {
+            if (x.back() < xMin) xMin = x.back();
+            if (x.back() > xMax) xMax = x.back();
 
-                if (y.back() < yMin) yMin = y.back();
-                if (y.back() > yMax) yMax = y.back();
+            if (y.back() < yMin) yMin = y.back();
+            if (y.back() > yMax) yMax = y.back();
 
-                if (z.back() < zMin) zMin = z.back();
-                if (z.back() > zMax) zMax = z.back();
+            if (z.back() < zMin) zMin = z.back();
+            if (z.back() > zMax) zMax = z.back();
 
-                if (dp.x < uMin) uMin = dp.x;
-                if (dp.x > uMax) uMax = dp.x;
+            if (px < uMin) uMin = px;
+            if (px > uMax) uMax = px;
 
-                if (dp.y < vMin) vMin = dp.y;
-                if (dp.y > vMax) vMax = dp.y;
+            if (py < vMin) vMin = py;
+            if (py > vMax) vMax = py;
 
-                if (dp.z < wMin) wMin = dp.z;
-                if (dp.z > wMax) wMax = dp.z;
-            }
+            if (pz < wMin) wMin = pz;
+            if (pz > wMax) wMax = pz;
         }
     }
 
@@ -257,33 +252,6 @@ void OrthoView::updateView()
     setViewRange(xMid - rMax / m_scale, xMid + rMax / m_scale,
                  yMid - rMax / m_scale, yMid + rMax / m_scale);
 
-    if (mMainWindow->markActive())
-    {
-        const DataPoint &dpEnd = mMainWindow->interpolateDataT(mMainWindow->markEnd());
-
-        QVector< double > xMark, yMark, zMark;
-
-        QVector3D cur;
-        if (mMainWindow->units() == PlotValue::Metric)
-        {
-            cur = QVector3D(dpEnd.x, dpEnd.y, dpEnd.z);
-        }
-        else
-        {
-            cur = QVector3D(dpEnd.x, dpEnd.y, dpEnd.z) * METERS_TO_FEET;
-        }
-
-        xMark.append(QVector3D::dotProduct(cur, rt));
-        yMark.append(QVector3D::dotProduct(cur, up));
-        zMark.append(QVector3D::dotProduct(cur, bk));
-
-        QCPGraph *graph = addGraph();
-        graph->setData(xMark, yMark);
-        graph->setPen(QPen(Qt::black, mMainWindow->lineThickness()));
-        graph->setLineStyle(QCPGraph::lsNone);
-        graph->setScatterStyle(QCPScatterStyle::ssDisc);
-    }
-
     if (mMainWindow->dataSize() > 0)
     {
         QVector< double > xMark, yMark, zMark;
@@ -299,15 +267,7 @@ void OrthoView::updateView()
             dp.x = distance * sin(bearing);
             dp.y = distance * cos(bearing);
 
-            QVector3D cur;
-            if (mMainWindow->units() == PlotValue::Metric)
-            {
-                cur = QVector3D(dp.x, dp.y, dp.z);
-            }
-            else
-            {
-                cur = QVector3D(dp.x, dp.y, dp.z) * METERS_TO_FEET;
-            }
+            const QVector3D cur = viewPosition(dp.x, dp.y, dp.z);
 
             xMark.append(QVector3D::dotProduct(cur, rt));
             yMark.append(QVector3D::dotProduct(cur, up));
@@ -349,6 +309,56 @@ void OrthoView::updateView()
     replot();
 }
 
+void OrthoView::updateCursor()
+{
+    // The mark is drawn over the plot when it is painted
+    update();
+}
+
+void OrthoView::paintEvent(
+        QPaintEvent *event)
+{
+    QCustomPlot::paintEvent(event);
+
+    if (mMainWindow->markActive())
+    {
+        QVector3D up, bk, rt;
+        cameraVectors(up, bk, rt);
+
+        const DataPoint dpEnd = mMainWindow->markPoint();
+        const QVector3D cur = viewPosition(dpEnd.x, dpEnd.y, dpEnd.z);
+
+        QPainter painter(this);
+        drawCursor(&painter, xAxis, yAxis,
+                   QVector3D::dotProduct(cur, rt),
+                   QVector3D::dotProduct(cur, up),
+                   mMainWindow->lineThickness());
+    }
+}
+
+void OrthoView::cameraVectors(
+        QVector3D &up,
+        QVector3D &bk,
+        QVector3D &rt) const
+{
+    up = QVector3D(-sin(m_elevation) * cos(m_azimuth),
+                   -sin(m_elevation) * sin(m_azimuth),
+                    cos(m_elevation));
+    bk = QVector3D(cos(m_elevation) * cos(m_azimuth),
+                   cos(m_elevation) * sin(m_azimuth),
+                   sin(m_elevation));
+    rt = QVector3D::crossProduct(up, bk);
+}
+
+QVector3D OrthoView::viewPosition(
+        double x,
+        double y,
+        double z) const
+{
+    // Position in display units
+    return QVector3D(x, y, z) * PlotValue::distanceFactor(mMainWindow->units());
+}
+
 void OrthoView::addOrientation()
 {
     QPainter painter(this);
@@ -358,13 +368,8 @@ void OrthoView::addOrientation()
     double valPerMM = valPerPix / mmPerPix;
 
     // Camera vectors
-    QVector3D up(-sin(m_elevation) * cos(m_azimuth),
-                 -sin(m_elevation) * sin(m_azimuth),
-                  cos(m_elevation));
-    QVector3D bk(cos(m_elevation) * cos(m_azimuth),
-                 cos(m_elevation) * sin(m_azimuth),
-                 sin(m_elevation));
-    QVector3D rt = QVector3D::crossProduct(up, bk);
+    QVector3D up, bk, rt;
+    cameraVectors(up, bk, rt);
 
     // Transformed basis
     QVector3D o(-rt.x() - rt.y() - rt.z(),
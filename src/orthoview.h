@@ -5,6 +5,7 @@
 
 class MainWindow;
 class QTimer;
+class QVector3D;
 
 class OrthoView : public QCustomPlot
 {
@@ -23,6 +24,8 @@ protected:
     void mouseMoveEvent(QMouseEvent *event);
     void wheelEvent(QWheelEvent *event);
 
+    void paintEvent(QPaintEvent *event);
+
 private:
     MainWindow *mMainWindow;
 
@@ -35,12 +38,16 @@ private:
 
     QTimer     *m_timer;
 
+    void cameraVectors(QVector3D &up, QVector3D &bk, QVector3D &rt) const;
+    QVector3D viewPosition(double x, double y, double z) const;
+
     void addOrientation();
     void setViewRange(double xMin, double xMax,
                       double yMin, double yMax);
 
 public slots:
     void updateView();
+    void updateCursor();
     void endTimer();
 };
 
@@ -65,7 +65,7 @@ void PlaybackView::play()
 
 void PlaybackView::tick()
 {
-    const DataPoint &dpEnd = mMainWindow->dataPoint(mMainWindow->dataSize() - 1);
+    const DataPoint dpEnd = mMainWindow->dataPoint(mMainWindow->dataSize() - 1);
 
     if (mMainWindow->rangeUpper() == dpEnd.t)
     {
@@ -110,7 +110,7 @@ void PlaybackView::setPosition(int position)
         const double upper = mMainWindow->rangeUpper() + INTERVAL / 1000.;
 
         // Get data range
-        const DataPoint &dpStart = mMainWindow->dataPoint(0);
+        const DataPoint dpStart = mMainWindow->dataPoint(0);
 
         // Change window position
         mMainWindow->setRange(
@@ -141,8 +141,8 @@ void PlaybackView::updateView()
         const double upper = mMainWindow->rangeUpper() + INTERVAL / 1000.;
 
         // Get data range
-        const DataPoint &dpStart = mMainWindow->dataPoint(0);
-        const DataPoint &dpEnd = mMainWindow->dataPoint(mMainWindow->dataSize() - 1);
+        const DataPoint dpStart = mMainWindow->dataPoint(0);
+        const DataPoint dpEnd = mMainWindow->dataPoint(mMainWindow->dataSize() - 1);
 
         // Update slider range
         const int duration = ((dpEnd.t - dpStart.t) - (upper - lower)) * 1000;
@@ -6,6 +6,7 @@
 #include <QString>
 
 #include "datapoint.h"
+#include "trackstore.h"
 #include "qcustomplot.h"
 
 #define METERS_TO_FEET 3.28084
@@ -44,13 +45,66 @@ public:
         return rawValue(dp) * factor(units);
     }
 
+    // Value at row i, reading only the columns it needs
+    double value(const TrackStore &track, int i, Units units) const
+    {
+        DataPoint dp;
+        track.read(i, columns(), dp);
+        return value(dp, units);
+    }
+
+    // Values for rows from begin to the end of a track, as stored, so
+    // without the offsets of its columns
+    void storedValues(const TrackStore &track, Units units, int begin, QVector< double > &result) const
+    {
+        const quint32 mask = columns();
+        const double f = factor(units);
+
+        result.resize(qMax(0, track.size() - begin));
+
+        DataPoint dp;
+        for (int i = 0; i < result.size(); ++i)
+        {
+            track.readRaw(begin + i, mask, dp);
+            result[i] = rawValue(dp) * f;
+        }
+    }
+
+    // Amount the offsets of a track take from each value. Values that read
+    // a column with an offset must give it here, which they can since they
+    // only add multiples of such columns to the rest.
+    virtual double offset(const TrackStore &track, Units units) const
+    {
+        Q_UNUSED(track);
+        Q_UNUSED(units);
+        return 0;
+    }
+
     virtual double rawValue(const DataPoint &dp) const = 0;
+
+    // Columns of TrackStore read by rawValue
+    virtual quint32 columns() const
+    {
+        return TrackStore::AllColumns;
+    }
     virtual double factor(Units units) const
     {
         Q_UNUSED(units);
         return 1;
     }
 
+    // Conversions from metres and metres per second to display units
+    static double distanceFactor(Units units)
+    {
+        return (units == Metric) ? 1
+                                 : METERS_TO_FEET;
+    }
+    static double speedFactor(Units units)
+    {
+        return (units == Metric) ? MPS_TO_KMH
+                                 : MPS_TO_MPH;
+    }
+
     void setMinimum(double minimum) { mMinimum = minimum; }
     double minimum() const { return mMinimum; }
 
@@ -139,10 +193,18 @@ public:
     {
         return DataPoint::elevation(dp);
     }
+    quint32 columns() const
+    {
+        return TrackStore::mask(TrackStore::Z);
+    }
     double factor(Units units) const
     {
-        return (units == Metric) ? 1
-                                 : METERS_TO_FEET;
+        return distanceFactor(units);
+    }
+
+    double offset(const TrackStore &track, Units units) const
+    {
+        return track.offset(TrackStore::Z) * factor(units);
     }
 
     bool hasOptimal() const { return true; }
@@ -167,10 +229,13 @@ public:
     {
         return DataPoint::verticalSpeed(dp);
     }
+    quint32 columns() const
+    {
+        return TrackStore::mask(TrackStore::VelD);
+    }
     double factor(Units units) const
     {
-        return (units == Metric) ? MPS_TO_KMH
-                                 : MPS_TO_MPH;
+        return speedFactor(units);
     }
 
     bool hasOptimal() const { return true; }
@@ -195,10 +260,14 @@ public:
     {
         return DataPoint::horizontalSpeed(dp);
     }
+    quint32 columns() const
+    {
+        return TrackStore::mask(TrackStore::Vx) |
+               TrackStore::mask(TrackStore::Vy);
+    }
     double factor(Units units) const
     {
-        return (units == Metric) ? MPS_TO_KMH
-                                 : MPS_TO_MPH;
+        return speedFactor(units);
     }
 
     bool hasOptimal() const { return true; }
@@ -223,10 +292,15 @@ public:
     {
         return DataPoint::totalSpeed(dp);
     }
+    quint32 columns() const
+    {
+        return TrackStore::mask(TrackStore::Vx) |
+               TrackStore::mask(TrackStore::Vy) |
+               TrackStore::mask(TrackStore::VelD);
+    }
     double factor(Units units) const
     {
-        return (units == Metric) ? MPS_TO_KMH
-                                 : MPS_TO_MPH;
+        return speedFactor(units);
     }
 
     bool hasOptimal() const { return true; }
@@ -251,6 +325,12 @@ public:
     {
         return DataPoint::diveAngle(dp);
     }
+    quint32 columns() const
+    {
+        return TrackStore::mask(TrackStore::Vx) |
+               TrackStore::mask(TrackStore::Vy) |
+               TrackStore::mask(TrackStore::VelD);
+    }
 
     bool hasOptimal() const { return true; }
 };
@@ -274,6 +354,10 @@ public:
     {
         return DataPoint::curvature(dp);
     }
+    quint32 columns() const
+    {
+        return TrackStore::mask(TrackStore::Curv);
+    }
 
     bool hasOptimal() const { return true; }
 };
@@ -297,6 +381,12 @@ public:
     {
         return DataPoint::glideRatio(dp);
     }
+    quint32 columns() const
+    {
+        return TrackStore::mask(TrackStore::Vx) |
+               TrackStore::mask(TrackStore::Vy) |
+               TrackStore::mask(TrackStore::VelD);
+    }
 
     bool hasOptimal() const { return true; }
 };
@@ -320,10 +410,13 @@ public:
     {
         return DataPoint::horizontalAccuracy(dp);
     }
+    quint32 columns() const
+    {
+        return TrackStore::mask(TrackStore::HAcc);
+    }
     double factor(Units units) const
     {
-        return (units == Metric) ? 1
-                                 : METERS_TO_FEET;
+        return distanceFactor(units);
     }
 };
 
@@ -346,10 +439,13 @@ public:
     {
         return DataPoint::verticalAccuracy(dp);
     }
+    quint32 columns() const
+    {
+        return TrackStore::mask(TrackStore::VAcc);
+    }
     double factor(Units units) const
     {
-        return (units == Metric) ? 1
-                                 : METERS_TO_FEET;
+        return distanceFactor(units);
     }
 };
 
@@ -372,10 +468,13 @@ public:
     {
         return DataPoint::speedAccuracy(dp);
     }
+    quint32 columns() const
+    {
+        return TrackStore::mask(TrackStore::SAcc);
+    }
     double factor(Units units) const
     {
-        return (units == Metric) ? MPS_TO_KMH
-                                 : MPS_TO_MPH;
+        return speedFactor(units);
     }
 };
 
@@ -398,6 +497,10 @@ public:
     {
         return DataPoint::numberOfSatellites(dp);
     }
+    quint32 columns() const
+    {
+        return TrackStore::mask(TrackStore::NumSV);
+    }
 };
 
 class PlotTime: public PlotValue
@@ -419,6 +522,16 @@ public:
     {
         return DataPoint::time(dp);
     }
+    quint32 columns() const
+    {
+        return TrackStore::mask(TrackStore::T);
+    }
+
+    double offset(const TrackStore &track, Units units) const
+    {
+        Q_UNUSED(units);
+        return track.offset(TrackStore::T);
+    }
 
     bool hasOptimal() const { return true; }
 };
@@ -442,10 +555,18 @@ public:
     {
         return DataPoint::distance2D(dp);
     }
+    quint32 columns() const
+    {
+        return TrackStore::mask(TrackStore::Dist2D);
+    }
     double factor(Units units) const
     {
-        return (units == Metric) ? 1
-                                 : METERS_TO_FEET;
+        return distanceFactor(units);
+    }
+
+    double offset(const TrackStore &track, Units units) const
+    {
+        return track.offset(TrackStore::Dist2D) * factor(units);
     }
 
     bool hasOptimal() const { return true; }
@@ -470,10 +591,18 @@ public:
     {
         return DataPoint::distance3D(dp);
     }
+    quint32 columns() const
+    {
+        return TrackStore::mask(TrackStore::Dist3D);
+    }
     double factor(Units units) const
     {
-        return (units == Metric) ? 1
-                                 : METERS_TO_FEET;
+        return distanceFactor(units);
+    }
+
+    double offset(const TrackStore &track, Units units) const
+    {
+        return track.offset(TrackStore::Dist3D) * factor(units);
     }
 
     bool hasOptimal() const { return true; }
@@ -498,6 +627,10 @@ public:
     {
         return DataPoint::acceleration(dp);
     }
+    quint32 columns() const
+    {
+        return TrackStore::mask(TrackStore::Accel);
+    }
 
     bool hasOptimal() const { return true; }
 };
@@ -521,6 +654,19 @@ public:
     {
         return DataPoint::totalEnergy(dp);
     }
+    quint32 columns() const
+    {
+        return TrackStore::mask(TrackStore::Vx) |
+               TrackStore::mask(TrackStore::Vy) |
+               TrackStore::mask(TrackStore::VelD) |
+               TrackStore::mask(TrackStore::Z);
+    }
+
+    double offset(const TrackStore &track, Units units) const
+    {
+        Q_UNUSED(units);
+        return A_GRAVITY * track.offset(TrackStore::Z);
+    }
 
     bool hasOptimal() const { return true; }
 };
@@ -544,6 +690,13 @@ public:
     {
         return DataPoint::energyRate(dp);
     }
+    quint32 columns() const
+    {
+        return TrackStore::mask(TrackStore::Vx) |
+               TrackStore::mask(TrackStore::Vy) |
+               TrackStore::mask(TrackStore::VelD) |
+               TrackStore::mask(TrackStore::Accel);
+    }
 
     bool hasOptimal() const { return true; }
 };
@@ -567,6 +720,10 @@ public:
     {
         return DataPoint::liftCoefficient(dp);
     }
+    quint32 columns() const
+    {
+        return TrackStore::mask(TrackStore::Lift);
+    }
 
     bool hasOptimal() const { return true; }
 };
@@ -590,6 +747,10 @@ public:
     {
         return DataPoint::dragCoefficient(dp);
     }
+    quint32 columns() const
+    {
+        return TrackStore::mask(TrackStore::Drag);
+    }
 
     bool hasOptimal() const { return true; }
 };
@@ -613,6 +774,16 @@ public:
     {
         return DataPoint::course(dp);
     }
+    quint32 columns() const
+    {
+        return TrackStore::mask(TrackStore::Theta);
+    }
+
+    double offset(const TrackStore &track, Units units) const
+    {
+        Q_UNUSED(units);
+        return track.offset(TrackStore::Theta);
+    }
 
     bool hasOptimal() const { return false; }
 };
@@ -636,6 +807,10 @@ public:
     {
         return DataPoint::courseRate(dp);
     }
+    quint32 columns() const
+    {
+        return TrackStore::mask(TrackStore::Omega);
+    }
 
     bool hasOptimal() const { return false; }
 };
@@ -659,6 +834,10 @@ public:
     {
         return DataPoint::courseAccuracy(dp);
     }
+    quint32 columns() const
+    {
+        return TrackStore::mask(TrackStore::CAcc);
+    }
 
     bool hasOptimal() const { return false; }
 };
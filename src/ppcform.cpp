@@ -72,7 +72,7 @@ void PPCForm::updateView()
     switch (mMainWindow->windowMode())
     {
     case MainWindow::Actual:
-        success = method->getWindowBounds(mMainWindow->data(), dpBottom, dpTop);
+        success = method->getWindowBounds(mMainWindow->track(), dpBottom, dpTop);
         break;
     case MainWindow::Optimal:
         success = method->getWindowBounds(mMainWindow->optimal(), dpBottom, dpTop);
@@ -2,6 +2,7 @@
 #define PPCSCORING_H
 
 #include "scoringmethod.h"
+#include "trackrows.h"
 
 class MainWindow;
 
@@ -26,7 +27,7 @@ public:
 
     void prepareDataPlot(DataPlot *plot);
 
-    bool getWindowBounds(const QVector< DataPoint > &result,
+    bool getWindowBounds(const TrackRows &result,
                          DataPoint &dpBottom, DataPoint &dpTop);
 
     void optimize() { ScoringMethod::optimize(mMainWindow, mWindowBottom); }
@@ -67,7 +67,7 @@ void SpeedForm::updateView()
     switch (mMainWindow->windowMode())
     {
     case MainWindow::Actual:
-        success = method->getWindowBounds(mMainWindow->data(), dpBottom, dpTop);
+        success = method->getWindowBounds(mMainWindow->track(), dpBottom, dpTop);
         break;
     case MainWindow::Optimal:
         success = method->getWindowBounds(mMainWindow->optimal(), dpBottom, dpTop);
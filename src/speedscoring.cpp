@@ -50,7 +50,7 @@ void SpeedScoring::prepareDataPlot(
     switch (mMainWindow->windowMode())
     {
     case MainWindow::Actual:
-        success = getWindowBounds(mMainWindow->data(), dpBottom, dpTop);
+        success = getWindowBounds(mMainWindow->track(), dpBottom, dpTop);
         break;
     case MainWindow::Optimal:
         success = getWindowBounds(mMainWindow->optimal(), dpBottom, dpTop);
@@ -123,7 +123,7 @@ void SpeedScoring::prepareDataPlot(
 }
 
 bool SpeedScoring::getWindowBounds(
-        const QVector< DataPoint > &result,
+        const TrackRows &result,
         DataPoint &dpBottom,
         DataPoint &dpTop)
 {
@@ -133,38 +133,38 @@ bool SpeedScoring::getWindowBounds(
 
     for (int i = result.size() - 1; i >= 0; --i)
     {
-        const DataPoint &dp = result[i];
+        const double z = result.z(i);
 
-        if (dp.z < mWindowBottom)
+        if (z < mWindowBottom)
         {
             bottom = i;
             foundBottom = true;
         }
 
-        if (dp.z < mWindowTop)
+        if (z < mWindowTop)
         {
             top = i;
             foundTop = false;
         }
 
-        if (dp.z > mWindowTop)
+        if (z > mWindowTop)
         {
             foundTop = true;
         }
 
-        if (dp.t < 0) break;
+        if (result.t(i) < 0) break;
     }
 
     if (foundBottom && foundTop)
     {
         // Calculate bottom of window
-        const DataPoint &dp1 = result[bottom - 1];
-        const DataPoint &dp2 = result[bottom];
+        const DataPoint dp1 = result[bottom - 1];
+        const DataPoint dp2 = result[bottom];
         dpBottom = DataPoint::interpolate(dp1, dp2, (mWindowBottom - dp1.z) / (dp2.z - dp1.z));
 
         // Calculate top of window
-        const DataPoint &dp3 = result[top - 1];
-        const DataPoint &dp4 = result[top];
+        const DataPoint dp3 = result[top - 1];
+        const DataPoint dp4 = result[top];
         dpTop = DataPoint::interpolate(dp3, dp4, (mWindowTop - dp3.z) / (dp4.z - dp3.z));
 
         return true;
@@ -0,0 +1,292 @@
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <string.h>
+
+#include "trackcache.h"
+
+// Double columns stored after the timestamps, in the order of TrackStore
+static const int numDoubleColumns = TrackStore::NumSV;
+
+static const char cacheMagic[8] = { 'F', 'S', 'V', 'C', 'A', 'C', 'H', 'E' };
+
+// Total size of entries kept by prune
+static const qint64 cacheLimit = Q_INT64_C(512) * 1024 * 1024;
+
+TrackCache::TrackCache(
+        const QString &trackFile,
+        const TrackProcessor &processor,
+        bool automaticGround):
+    mTrackFile(trackFile)
+{
+    QFileInfo info(trackFile);
+    mPath = info.absoluteFilePath().toUtf8();
+
+    // One cache file per track, named after its path
+    const QByteArray hash = QCryptographicHash::hash(mPath, QCryptographicHash::Sha1);
+    mCacheFile = cacheDir() + "/" + hash.toHex() + ".cache";
+
+    // Key stored in the header
+    memset(&mHeader, 0, sizeof(mHeader));
+    memcpy(mHeader.magic, cacheMagic, sizeof(mHeader.magic));
+    mHeader.version = Version;
+
+    mHeader.fileSize = info.size();
+    mHeader.lastModified = info.lastModified().toMSecsSinceEpoch();
+
+    mHeader.windE = processor.windE();
+    mHeader.windN = processor.windN();
+    mHeader.windAdjustment = processor.windAdjustment();
+    mHeader.pathSize = mPath.size();
+
+    mHeader.mass = processor.mass();
+    mHeader.planformArea = processor.planformArea();
+    mHeader.groundReference = automaticGround ? 0 : processor.groundReference();
+    mHeader.exactGeodesic = processor.exactGeodesic();
+    mHeader.automaticGround = automaticGround;
+    mHeader.slopeWindow = processor.slopeWindow();
+}
+
+QString TrackCache::cacheDir()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+            + "/tracks";
+}
+
+qint64 TrackCache::dataOffset() const
+{
+    return align(sizeof(Header) + mPath.size());
+}
+
+qint64 TrackCache::cacheSize(
+        int rows) const
+{
+    // Timestamps, doubles, then two 32-bit integer columns
+    qint64 size = dataOffset();
+    size += (qint64) rows * sizeof(qint64);
+    size += (qint64) rows * sizeof(double) * numDoubleColumns;
+    size += align((qint64) rows * sizeof(qint32)) * 2;
+    return size;
+}
+
+bool TrackCache::read(
+        TrackStore &track) const
+{
+    QFile file(mCacheFile);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    const qint64 size = file.size();
+    if (size < dataOffset()) return false;
+
+    const uchar *map = file.map(0, size);
+    if (!map) return false;
+
+    // Check key
+    Header header;
+    memcpy(&header, map, sizeof(header));
+    header.rows = 0;
+
+    bool valid = !memcmp(&header, &mHeader, sizeof(header))
+            && !memcmp(map + sizeof(Header), mPath.constData(), mPath.size());
+
+    const quint32 rows = ((const Header *) map)->rows;
+    if (!valid || size != cacheSize(rows))
+    {
+        file.unmap((uchar *) map);
+        return false;
+    }
+
+    // Each column is copied out of the map in one block. The track owns its
+    // columns, so they can be converted, appended to and shared like those
+    // of any other track.
+    track.clear();
+    track.clearOffsets();
+    track.resize(rows);
+
+    const uchar *p = map + dataOffset();
+
+    track.setTimestamps((const qint64 *) p);
+    p += rows * sizeof(qint64);
+
+    for (int j = 0; j < numDoubleColumns; ++j)
+    {
+        track.setColumn((TrackStore::Column) j, (const double *) p);
+        p += rows * sizeof(double);
+    }
+
+    track.setColumn(TrackStore::NumSV, (const qint32 *) p);
+    p += align(rows * sizeof(qint32));
+
+    track.setColumn(TrackStore::HasGeodetic, (const qint32 *) p);
+
+    file.unmap((uchar *) map);
+    return true;
+}
+
+bool TrackCache::write(
+        const TrackStore &track) const
+{
+    // Don't cache a file that changed while it was read
+    QFileInfo info(mTrackFile);
+    if (info.size() != mHeader.fileSize
+            || info.lastModified().toMSecsSinceEpoch() != mHeader.lastModified)
+    {
+        return false;
+    }
+
+    if (!QDir().mkpath(QFileInfo(mCacheFile).absolutePath())) return false;
+
+    const int rows = track.size();
+
+    // Replace the old entry atomically. Values are written straight to the
+    // file a column at a time, converted a block of rows at a time where
+    // they aren't stored as written.
+    QSaveFile file(mCacheFile);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+
+    Header header = mHeader;
+    header.rows = rows;
+
+    bool ok = writeData(file, &header, sizeof(header))
+            && writeData(file, mPath.constData(), mPath.size())
+            && writePadding(file);
+
+    QVector< qint64 > timestamps;
+    for (int begin = 0; ok && begin < rows; begin += BlockRows)
+    {
+        const int end = qMin(begin + (int) BlockRows, rows);
+
+        timestamps.resize(end - begin);
+        for (int i = begin; i < end; ++i)
+        {
+            timestamps[i - begin] = track.timestamp(i);
+        }
+
+        ok = writeData(file, timestamps.constData(), timestamps.size() * sizeof(qint64));
+    }
+
+    QVector< double > values;
+    for (int j = 0; ok && j < numDoubleColumns; ++j)
+    {
+        const TrackStore::Column c = (TrackStore::Column) j;
+        const double *stored = track.column(c).data();
+
+        if (stored)
+        {
+            ok = writeData(file, stored, rows * sizeof(double));
+            continue;
+        }
+
+        for (int begin = 0; ok && begin < rows; begin += BlockRows)
+        {
+            const int end = qMin(begin + (int) BlockRows, rows);
+
+            values.resize(end - begin);
+            for (int i = begin; i < end; ++i)
+            {
+                values[i - begin] = track.rawValue(i, c);
+            }
+
+            ok = writeData(file, values.constData(), values.size() * sizeof(double));
+        }
+    }
+
+    QVector< qint32 > integers;
+    for (int k = 0; ok && k < 2; ++k)
+    {
+        for (int begin = 0; ok && begin < rows; begin += BlockRows)
+        {
+            const int end = qMin(begin + (int) BlockRows, rows);
+
+            integers.resize(end - begin);
+            for (int i = begin; i < end; ++i)
+            {
+                integers[i - begin] = (k == 0) ? (qint32) track.rawValue(i, TrackStore::NumSV)
+                                               : (qint32) track.hasGeodetic(i);
+            }
+
+            ok = writeData(file, integers.constData(), integers.size() * sizeof(qint32));
+        }
+
+        ok = ok && writePadding(file);
+    }
+
+    if (!ok || file.pos() != cacheSize(rows))
+    {
+        file.cancelWriting();
+        return false;
+    }
+
+    if (!file.commit()) return false;
+
+    prune();
+    return true;
+}
+
+bool TrackCache::writeData(
+        QSaveFile &file,
+        const void *data,
+        qint64 size)
+{
+    return file.write((const char *) data, size) == size;
+}
+
+bool TrackCache::writePadding(
+        QSaveFile &file)
+{
+    // Zeros up to the next aligned offset
+    static const char zeros[8] = { 0 };
+    const qint64 pos = file.pos();
+
+    return writeData(file, zeros, align(pos) - pos);
+}
+
+void TrackCache::prune()
+{
+    QDir dir(cacheDir());
+    const QFileInfoList entries = dir.entryInfoList(
+                QStringList("*.cache"), QDir::Files, QDir::Time);
+
+    // Newest first, so the oldest are removed once the limit is reached
+    qint64 total = 0;
+
+    foreach (const QFileInfo &entry, entries)
+    {
+        bool keep = false;
+
+        QFile file(entry.absoluteFilePath());
+        if (file.open(QIODevice::ReadOnly))
+        {
+            Header header;
+            if (file.read((char *) &header, sizeof(header)) == sizeof(header)
+                    && !memcmp(header.magic, cacheMagic, sizeof(header.magic))
+                    && header.version == Version
+                    && header.pathSize >= 0)
+            {
+                // Keep entries whose track is unchanged
+                const QString path = QString::fromUtf8(file.read(header.pathSize));
+                QFileInfo info(path);
+
+                keep = info.exists()
+                        && info.size() == header.fileSize
+                        && info.lastModified().toMSecsSinceEpoch() == header.lastModified;
+            }
+
+            file.close();
+        }
+
+        if (keep && total + entry.size() <= cacheLimit)
+        {
+            total += entry.size();
+        }
+        else
+        {
+            QFile::remove(entry.absoluteFilePath());
+        }
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef TRACKCACHE_H
+#define TRACKCACHE_H
+
+#include <QString>
+
+class QSaveFile;
+
+#include "trackprocessor.h"
+#include "trackstore.h"
+
+// Binary cache of imported tracks, including derived values. Entries are
+// keyed by the track file's path, size and modification time and by the
+// settings used to compute derived values. An automatic ground reference
+// is keyed by the setting rather than the altitude of the last row, so the
+// key is known before the file is read, which compressed files need. Columns are stored contiguously
+// and aligned, so reading maps the file and copies each column out in one
+// block; nothing is parsed or recomputed. Writing streams the file a column
+// at a time without building it in memory.
+//
+// Entries whose track has changed or gone are removed whenever one is
+// written, as are the oldest entries once the cache grows past its limit.
+
+class TrackCache
+{
+public:
+    TrackCache(const QString &trackFile, const TrackProcessor &processor,
+               bool automaticGround);
+
+    // Reads into the storage the track is set up with
+    bool read(TrackStore &track) const;
+    bool write(const TrackStore &track) const;
+
+    const QString &fileName() const { return mCacheFile; }
+
+    // Removes stale entries, then the oldest ones above the size limit
+    static void prune();
+
+private:
+    // Increment whenever the layout or derived values change
+    enum { Version = 6 };
+
+    typedef struct {
+        char    magic[8];
+        quint32 version;
+        quint32 rows;
+
+        qint64  fileSize;
+        qint64  lastModified;
+
+        double  windE;
+        double  windN;
+        qint32  windAdjustment;
+        qint32  pathSize;
+
+        double  mass;
+        double  planformArea;
+        double  groundReference;
+        qint32  exactGeodesic;
+        qint32  automaticGround;
+        double  slopeWindow;
+    } Header;
+
+    QString    mTrackFile;
+    QString    mCacheFile;
+    QByteArray mPath;
+    Header     mHeader;
+
+    static QString cacheDir();
+
+    // Rows converted at a time when writing
+    enum { BlockRows = 65536 };
+
+    static qint64 align(qint64 offset) { return (offset + 7) & ~7; }
+    static bool writeData(QSaveFile &file, const void *data, qint64 size);
+    static bool writePadding(QSaveFile &file);
+    qint64 dataOffset() const;
+    qint64 cacheSize(int rows) const;
+};
+
+#endif // TRACKCACHE_H
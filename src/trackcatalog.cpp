@@ -0,0 +1,247 @@
+#include <QRunnable>
+#include <QThreadPool>
+
+#include "trackcache.h"
+#include "trackcatalog.h"
+#include "trackparser.h"
+
+// Rows parsed at a time, so the track is only held once as rows
+#define LOAD_ROWS 65536
+
+// Loads and processes one track on a pool thread
+class TrackLoader : public QRunnable
+{
+public:
+    TrackLoader(TrackCatalog *catalog, const QAtomicInt *cancelled,
+                const QString &fileName, const TrackProcessor &processor,
+                bool automaticGround, bool compact):
+        mCatalog(catalog),
+        mCancelled(cancelled),
+        mFileName(fileName),
+        mProcessor(processor),
+        mAutomaticGround(automaticGround),
+        mCompact(compact)
+    {
+
+    }
+
+    void run()
+    {
+        TrackStore track;
+
+        bool success = load(track);
+        if (cancelled()) return;
+
+        track.setCompact(mCompact);
+
+        // The catalog waits for its loaders before it is destroyed
+        QMetaObject::invokeMethod(mCatalog, "loadFinished", Qt::QueuedConnection,
+                                  Q_ARG(QString, mFileName),
+                                  Q_ARG(TrackStore, track),
+                                  Q_ARG(TrackProcessor, mProcessor),
+                                  Q_ARG(bool, success));
+    }
+
+private:
+    TrackCatalog     *mCatalog;
+    const QAtomicInt *mCancelled;
+    QString           mFileName;
+    TrackProcessor    mProcessor;
+    bool              mAutomaticGround;
+    bool              mCompact;
+
+    bool cancelled() const
+    {
+        return mCancelled->load() != 0;
+    }
+
+    bool readRows(TrackParser &parser, TrackStore &track)
+    {
+        QVector< DataPoint > data;
+
+        while (!parser.atEnd() && !cancelled())
+        {
+            data.clear();
+            parser.readRows(data, LOAD_ROWS);
+
+            track.append(data);
+        }
+
+        return !parser.failed() && !cancelled();
+    }
+
+    bool load(TrackStore &track)
+    {
+        TrackParser parser;
+        if (!parser.open(mFileName)) return false;
+
+        // Use cached values if nothing has changed
+        TrackCache cache(mFileName, mProcessor, mAutomaticGround);
+        if (cache.read(track) && !track.isEmpty())
+        {
+            mProcessor.setReference(track.at(track.size() - 1), mAutomaticGround);
+            return true;
+        }
+
+        if (parser.isCompressed())
+        {
+            // The last row is only known once everything has been read
+            if (!readRows(parser, track) || track.isEmpty()) return false;
+
+            mProcessor.setReference(track.at(track.size() - 1), mAutomaticGround);
+        }
+        else
+        {
+            // Read reference values from the last row
+            DataPoint dp0;
+            if (!parser.readLastRow(dp0)) return false;
+
+            mProcessor.setReference(dp0, mAutomaticGround);
+
+            if (!readRows(parser, track)) return false;
+        }
+
+        mProcessor.processAll(track);
+
+        cache.write(track);
+        return true;
+    }
+};
+
+TrackCatalog::TrackCatalog(QObject *parent) :
+    QObject(parent),
+    mLimit(10),
+    mCompact(false),
+    mCancelled(0)
+{
+
+}
+
+TrackCatalog::~TrackCatalog()
+{
+    // Loaders still running post back to the catalog, so stop them first
+    mCancelled.store(1);
+    mPool.waitForDone();
+}
+
+void TrackCatalog::setLimit(
+        int limit)
+{
+    mLimit = qMax(1, limit);
+    evict();
+
+    emit catalogChanged();
+}
+
+void TrackCatalog::setCompact(
+        bool compact)
+{
+    mCompact = compact;
+
+    foreach (const QString &fileName, mResident.keys())
+    {
+        mResident[fileName].track.setCompact(compact);
+    }
+}
+
+void TrackCatalog::load(
+        const QStringList &fileNames,
+        const TrackProcessor &processor,
+        bool automaticGround)
+{
+    foreach (const QString &fileName, fileNames)
+    {
+        if (mLoading.contains(fileName)) continue;
+
+        if (!mFileNames.contains(fileName))
+        {
+            mFileNames.append(fileName);
+        }
+
+        // Tracks beyond the limit would only be dropped again, so they are
+        // loaded when they are selected
+        if (mResident.contains(fileName) || mLoading.size() >= mLimit) continue;
+
+        mLoading.insert(fileName);
+
+        mPool.start(new TrackLoader(this, &mCancelled, fileName, processor,
+                                    automaticGround, mCompact));
+    }
+
+    emit catalogChanged();
+}
+
+void TrackCatalog::insert(
+        const QString &fileName,
+        const TrackStore &track,
+        const TrackProcessor &processor)
+{
+    if (!mFileNames.contains(fileName))
+    {
+        mFileNames.append(fileName);
+    }
+
+    Entry &entry = mResident[fileName];
+    entry.track = track;
+    entry.processor = processor;
+
+    touch(fileName);
+    evict();
+
+    emit catalogChanged();
+}
+
+bool TrackCatalog::get(
+        const QString &fileName,
+        TrackStore &track,
+        TrackProcessor &processor)
+{
+    if (!mResident.contains(fileName)) return false;
+
+    const Entry &entry = mResident[fileName];
+    track = entry.track;
+    processor = entry.processor;
+
+    touch(fileName);
+    return true;
+}
+
+void TrackCatalog::loadFinished(
+        const QString &fileName,
+        const TrackStore &track,
+        const TrackProcessor &processor,
+        bool success)
+{
+    mLoading.remove(fileName);
+
+    if (success && !track.isEmpty())
+    {
+        insert(fileName, track, processor);
+        emit trackLoaded(fileName);
+    }
+    else
+    {
+        // Drop tracks that can't be read
+        if (!mResident.contains(fileName))
+        {
+            mFileNames.removeAll(fileName);
+        }
+
+        emit catalogChanged();
+    }
+}
+
+void TrackCatalog::touch(
+        const QString &fileName)
+{
+    mRecent.removeAll(fileName);
+    mRecent.prepend(fileName);
+}
+
+void TrackCatalog::evict()
+{
+    while (mRecent.size() > mLimit)
+    {
+        mResident.remove(mRecent.takeLast());
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef TRACKCATALOG_H
+#define TRACKCATALOG_H
+
+#include <QAtomicInt>
+#include <QMap>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+
+#include "trackprocessor.h"
+#include "trackstore.h"
+
+// Collection of imported tracks. Tracks are loaded in parallel on the
+// catalog's own thread pool, which is cancelled and waited for when the
+// catalog is destroyed. At most limit() tracks are kept in memory, so no more
+// than that are queued at once; the rest are listed and loaded when they are
+// selected, and the least recently used ones are dropped and reloaded when
+// they are needed again. Tracks are shared with their users, so the track
+// being shown is only stored once as long as it is inserted again whenever it
+// changes.
+
+class TrackCatalog : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TrackCatalog(QObject *parent = 0);
+    ~TrackCatalog();
+
+    void setLimit(int limit);
+    int limit() const { return mLimit; }
+
+    // Storage used for tracks, including those already loaded
+    void setCompact(bool compact);
+    bool isCompact() const { return mCompact; }
+
+    void load(const QStringList &fileNames, const TrackProcessor &processor,
+              bool automaticGround);
+    void insert(const QString &fileName, const TrackStore &track,
+                const TrackProcessor &processor);
+
+    bool get(const QString &fileName, TrackStore &track,
+             TrackProcessor &processor);
+
+    const QStringList &fileNames() const { return mFileNames; }
+
+    bool isLoading(const QString &fileName) const { return mLoading.contains(fileName); }
+    bool isResident(const QString &fileName) const { return mResident.contains(fileName); }
+
+signals:
+    void trackLoaded(const QString &fileName);
+    void catalogChanged();
+
+private slots:
+    void loadFinished(const QString &fileName, const TrackStore &track,
+                      const TrackProcessor &processor, bool success);
+
+private:
+    typedef struct {
+        TrackStore     track;
+        TrackProcessor processor;
+    } Entry;
+
+    QStringList             mFileNames;
+    QMap< QString, Entry >  mResident;
+    QStringList             mRecent;    // Most recently used first
+    QSet< QString >         mLoading;
+
+    int                     mLimit;
+    bool                    mCompact;
+
+    QThreadPool             mPool;
+    QAtomicInt              mCancelled;
+
+    void touch(const QString &fileName);
+    void evict();
+};
+
+#endif // TRACKCATALOG_H
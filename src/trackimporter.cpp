@@ -0,0 +1,211 @@
+#include <QElapsedTimer>
+
+#include "trackcache.h"
+#include "trackimporter.h"
+#include "trackkernel.h"
+#include "trackparser.h"
+
+// Rows read between checks for cancellation
+#define CHUNK_ROWS     1000
+
+// Minimum interval between chunks sent to the GUI thread
+#define CHUNK_INTERVAL 100
+
+TrackImporter::TrackImporter():
+    mActive(0),
+    mCacheId(-1)
+{
+
+}
+
+TrackImporter::~TrackImporter()
+{
+
+}
+
+void TrackImporter::setActive(
+        int id)
+{
+    mActive.store(id);
+}
+
+void TrackImporter::importFile(
+        int id,
+        const QString &fileName,
+        const TrackProcessor &settings,
+        bool automaticGround)
+{
+    if (!isActive(id)) return;
+
+    TrackParser parser;
+    TrackProcessor processor = settings;
+
+    if (!parser.open(fileName))
+    {
+        emit finished(id, OpenFailed);
+        return;
+    }
+
+    if (parser.isCompressed())
+    {
+        importCompressed(id, fileName, parser, processor, automaticGround);
+        return;
+    }
+
+    // Rows are timed and positioned relative to the last one
+    DataPoint dp0;
+    if (!parser.readLastRow(dp0))
+    {
+        emit finished(id, NoRows);
+        return;
+    }
+
+    processor.setReference(dp0, automaticGround);
+
+    emit started(id, processor);
+
+    // Use cached values if nothing has changed
+    TrackCache cache(fileName, processor, automaticGround);
+    TrackStore track;
+
+    if (cache.read(track))
+    {
+        emit trackReady(id, track);
+        emit finished(id, Completed);
+        return;
+    }
+
+    // Rows are processed as they are parsed
+    TrackKernel kernel(processor);
+    DataPoint dp;
+
+    QVector< DataPoint > data;      // Rows not yet sent to the GUI thread
+
+    QElapsedTimer timer;
+    timer.start();
+
+    while (!parser.atEnd())
+    {
+        if (!isActive(id))
+        {
+            emit finished(id, Canceled);
+            return;
+        }
+
+        for (int i = 0; i < CHUNK_ROWS && parser.readRow(dp); ++i)
+        {
+            kernel.addRow(dp, data);
+        }
+
+        if (parser.atEnd()) kernel.finish(data);
+
+        if (!data.isEmpty()
+                && (parser.atEnd() || timer.elapsed() >= CHUNK_INTERVAL))
+        {
+            emit chunkReady(id, data, (int) (parser.progress() * 100));
+            data.clear();
+
+            timer.restart();
+        }
+    }
+
+    // The GUI thread holds the only copy of the rows, and sends them back
+    // to be cached once it has them all
+    setPendingCache(id, cache, processor);
+
+    emit finished(id, Completed);
+}
+
+void TrackImporter::writeCache(
+        int id,
+        const TrackStore &track,
+        const TrackProcessor &processor)
+{
+    if (id != mCacheId || !mCache) return;
+
+    // Rows recomputed with other settings since they were imported don't
+    // match the key
+    if (processor.changedColumns(mCacheProcessor) == 0)
+    {
+        mCache->write(track);
+    }
+
+    mCache.reset();
+}
+
+void TrackImporter::setPendingCache(
+        int id,
+        const TrackCache &cache,
+        const TrackProcessor &processor)
+{
+    mCacheId = id;
+    mCache.reset(new TrackCache(cache));
+    mCacheProcessor = processor;
+}
+
+void TrackImporter::importCompressed(
+        int id,
+        const QString &fileName,
+        TrackParser &parser,
+        TrackProcessor &processor,
+        bool automaticGround)
+{
+    // The key doesn't need the last row, so cached tracks are used without
+    // inflating the file
+    TrackCache cache(fileName, processor, automaticGround);
+    TrackStore track;
+
+    const bool cached = cache.read(track) && !track.isEmpty();
+
+    if (!cached)
+    {
+        // Rows are read straight into columns, so the track is never held
+        // as rows
+        QVector< DataPoint > data;
+
+        QElapsedTimer timer;
+        timer.start();
+
+        while (!parser.atEnd())
+        {
+            if (!isActive(id))
+            {
+                emit finished(id, Canceled);
+                return;
+            }
+
+            data.clear();
+            parser.readRows(data, CHUNK_ROWS);
+            track.append(data);
+
+            if (timer.elapsed() >= CHUNK_INTERVAL)
+            {
+                emit progressChanged(id, (int) (parser.progress() * 100));
+                timer.restart();
+            }
+        }
+
+        if (parser.failed())
+        {
+            emit finished(id, Corrupt);
+            return;
+        }
+
+        if (track.isEmpty())
+        {
+            emit finished(id, NoRows);
+            return;
+        }
+    }
+
+    // Derived values relative to the last row
+    processor.setReference(track.at(track.size() - 1), automaticGround);
+    if (!cached) processor.processAll(track);
+
+    emit started(id, processor);
+    emit trackReady(id, track);
+    emit finished(id, Completed);
+
+    // The GUI thread shares the columns until it changes them
+    if (!cached) cache.write(track);
+}
@@ -0,0 +1,73 @@
+#ifndef TRACKIMPORTER_H
+#define TRACKIMPORTER_H
+
+#include <QAtomicInt>
+#include <QObject>
+#include <QScopedPointer>
+#include <QVector>
+
+#include "datapoint.h"
+#include "trackprocessor.h"
+#include "trackstore.h"
+
+class TrackCache;
+class TrackParser;
+
+// Reads a track and computes derived values on the thread the importer
+// lives in. Finished rows are sent back in chunks as they become available.
+// Compressed tracks are sent in one piece once they have been read, since
+// their last row isn't known until then, and cached tracks are sent whole;
+// the importer caches compressed tracks itself.
+// The importer doesn't keep the rows it sends; the GUI thread sends the
+// finished track back to writeCache, which stores it under the key taken
+// when the import started.
+
+class TrackImporter : public QObject
+{
+    Q_OBJECT
+public:
+    typedef enum {
+        Completed, Canceled,
+        OpenFailed,     // File couldn't be opened
+        NoRows,         // No rows could be read
+        Corrupt         // Compressed data was corrupt or ended early
+    } Status;
+
+    explicit TrackImporter();
+    ~TrackImporter();
+
+    // Safe to call from any thread. Imports with a different id stop at the
+    // next chunk.
+    void setActive(int id);
+
+signals:
+    void started(int id, const TrackProcessor &processor);
+    void chunkReady(int id, const QVector< DataPoint > &data, int progress);
+    void trackReady(int id, const TrackStore &track);
+    void progressChanged(int id, int progress);
+    void finished(int id, int status);
+
+public slots:
+    void importFile(int id, const QString &fileName,
+                    const TrackProcessor &processor, bool automaticGround);
+    void writeCache(int id, const TrackStore &track,
+                    const TrackProcessor &processor);
+
+private:
+    QAtomicInt mActive;
+
+    // Cache entry of the last import, until its track is sent back
+    int                          mCacheId;
+    QScopedPointer< TrackCache > mCache;
+    TrackProcessor               mCacheProcessor;
+
+    bool isActive(int id) const { return mActive.load() == id; }
+
+    void setPendingCache(int id, const TrackCache &cache,
+                         const TrackProcessor &processor);
+
+    void importCompressed(int id, const QString &fileName, TrackParser &parser,
+                          TrackProcessor &processor, bool automaticGround);
+};
+
+#endif // TRACKIMPORTER_H
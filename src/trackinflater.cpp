@@ -0,0 +1,214 @@
+#include <QFile>
+#include <QMutexLocker>
+
+#include <string.h>
+
+#ifdef BUNDLED_ZLIB
+#include <QtZlib/zlib.h>
+#else
+#include <zlib.h>
+#endif
+
+#include "trackinflater.h"
+
+// Size of compressed reads
+#define INPUT_SIZE  65536
+
+// Size of decompressed chunks
+#define CHUNK_SIZE  262144
+
+// Chunks waiting to be parsed
+#define MAX_CHUNKS  4
+
+TrackInflater::TrackInflater(
+        const QString &fileName):
+    mFileName(fileName),
+    mFinished(false),
+    mFailed(false),
+    mStop(false),
+    mSize(0),
+    mConsumed(0)
+{
+
+}
+
+TrackInflater::~TrackInflater()
+{
+    // Stop decompression
+    mMutex.lock();
+    mStop = true;
+    mChanged.wakeAll();
+    mMutex.unlock();
+
+    wait();
+}
+
+bool TrackInflater::isCompressed(
+        const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    unsigned char magic[2];
+    if (file.read((char *) magic, 2) != 2)
+    {
+        return false;
+    }
+
+    // gzip header
+    if (magic[0] == 0x1f && magic[1] == 0x8b) return true;
+
+    // zlib header
+    return (magic[0] & 0x0f) == Z_DEFLATED
+            && (magic[0] >> 4) <= 7
+            && (magic[0] * 256 + magic[1]) % 31 == 0;
+}
+
+bool TrackInflater::read(
+        QByteArray &chunk)
+{
+    QMutexLocker locker(&mMutex);
+
+    while (mChunks.isEmpty() && !mFinished)
+    {
+        mChanged.wait(&mMutex);
+    }
+
+    if (mChunks.isEmpty()) return false;
+
+    chunk = mChunks.dequeue();
+    mChanged.wakeAll();
+
+    return true;
+}
+
+bool TrackInflater::failed() const
+{
+    QMutexLocker locker(&mMutex);
+    return mFailed;
+}
+
+double TrackInflater::progress() const
+{
+    QMutexLocker locker(&mMutex);
+    return (mSize > 0) ? (double) mConsumed / mSize : 1;
+}
+
+bool TrackInflater::push(
+        const QByteArray &chunk)
+{
+    QMutexLocker locker(&mMutex);
+
+    while (mChunks.size() >= MAX_CHUNKS && !mStop)
+    {
+        mChanged.wait(&mMutex);
+    }
+
+    if (mStop) return false;
+
+    mChunks.enqueue(chunk);
+    mChanged.wakeAll();
+
+    return true;
+}
+
+void TrackInflater::finish(
+        bool success)
+{
+    QMutexLocker locker(&mMutex);
+
+    mFinished = true;
+    mFailed = !success;
+    mChanged.wakeAll();
+}
+
+void TrackInflater::run()
+{
+    QFile file(mFileName);
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+
+    // Accept both gzip and zlib headers
+    if (!file.open(QIODevice::ReadOnly)
+            || inflateInit2(&stream, 15 + 32) != Z_OK)
+    {
+        finish(false);
+        return;
+    }
+
+    mMutex.lock();
+    mSize = file.size();
+    mMutex.unlock();
+
+    QByteArray input(INPUT_SIZE, 0);
+    QByteArray chunk(CHUNK_SIZE, 0);
+    int used = 0;
+
+    bool success = false;
+    bool ended = false;     // At the end of a gzip member
+
+    for (;;)
+    {
+        // Read more compressed data
+        if (stream.avail_in == 0)
+        {
+            const qint64 n = file.read(input.data(), INPUT_SIZE);
+            if (n <= 0)
+            {
+                success = (n == 0 && ended);
+                break;
+            }
+
+            stream.next_in = (Bytef *) input.data();
+            stream.avail_in = n;
+
+            mMutex.lock();
+            mConsumed += n;
+            mMutex.unlock();
+        }
+
+        // Concatenated gzip members
+        if (ended && inflateReset(&stream) != Z_OK) break;
+
+        stream.next_out = (Bytef *) chunk.data() + used;
+        stream.avail_out = CHUNK_SIZE - used;
+
+        const int ret = inflate(&stream, Z_NO_FLUSH);
+        used = CHUNK_SIZE - stream.avail_out;
+
+        if (ret == Z_DATA_ERROR && ended)
+        {
+            // Ignore trailing garbage, as gzip does
+            success = true;
+            break;
+        }
+
+        if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) break;
+
+        ended = (ret == Z_STREAM_END);
+
+        // Hand over full chunks
+        if (used == CHUNK_SIZE)
+        {
+            if (!push(chunk)) break;
+
+            chunk = QByteArray(CHUNK_SIZE, 0);
+            used = 0;
+        }
+    }
+
+    // Hand over the remainder
+    if (used > 0)
+    {
+        chunk.resize(used);
+        push(chunk);
+    }
+
+    inflateEnd(&stream);
+
+    finish(success);
+}
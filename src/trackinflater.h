@@ -0,0 +1,50 @@
+#ifndef TRACKINFLATER_H
+#define TRACKINFLATER_H
+
+#include <QByteArray>
+#include <QMutex>
+#include <QQueue>
+#include <QString>
+#include <QThread>
+#include <QWaitCondition>
+
+// Decompresses a gzip or zlib file on its own thread. Output is handed over
+// in chunks through a short queue, so decompression overlaps with parsing
+// and only a few chunks are held in memory at any time.
+
+class TrackInflater : public QThread
+{
+public:
+    explicit TrackInflater(const QString &fileName);
+    ~TrackInflater();
+
+    static bool isCompressed(const QString &fileName);
+
+    // Waits for the next chunk. Returns false at the end of the stream.
+    bool read(QByteArray &chunk);
+
+    bool failed() const;
+    double progress() const;
+
+protected:
+    void run();
+
+private:
+    QString              mFileName;
+
+    mutable QMutex       mMutex;
+    QWaitCondition       mChanged;
+    QQueue< QByteArray > mChunks;
+
+    bool                 mFinished;
+    bool                 mFailed;
+    bool                 mStop;
+
+    qint64               mSize;
+    qint64               mConsumed;
+
+    bool push(const QByteArray &chunk);
+    void finish(bool success);
+};
+
+#endif // TRACKINFLATER_H
@@ -0,0 +1,110 @@
+#include "trackkernel.h"
+
+#include "atmosphere.h"
+
+namespace
+{
+
+// Slopes computed for each row, in the order they are stored
+const DerivativeEngine::Value values[] = {
+    DataPoint::diveAngle,
+    DataPoint::totalSpeed,
+    DataPoint::course,
+    DataPoint::northSpeed,
+    DataPoint::eastSpeed,
+    DataPoint::verticalSpeed
+};
+
+const int numValues = sizeof(values) / sizeof(values[0]);
+
+}
+
+TrackKernel::TrackKernel(
+        const TrackProcessor &processor):
+    mProcessor(processor),
+    mProjected(processor.projected()),
+    mNext(0)
+{
+    if (mProjected)
+    {
+        const DataPoint &dp0 = mProcessor.origin();
+        mProj.Reset(dp0.lat, dp0.lon, 0);
+    }
+}
+
+void TrackKernel::addRow(
+        const DataPoint &raw,
+        QVector< DataPoint > &output)
+{
+    DataPoint dp = raw;
+
+    // Values depending only on this row
+    mProcessor.rowTime(dp);
+    mProcessor.rowAltitude(dp);
+    mProcessor.rowPosition(dp, mProjected ? &mProj : 0);
+    mProcessor.rowVelocity(dp);
+    TrackProcessor::rowRawHeading(dp);
+
+    // Values depending on the previous row
+    const DataPoint *dpPrev = mRows.isEmpty() ? 0 : &mRows.last();
+
+    TrackProcessor::rowStep(dp, dpPrev);
+    if (dpPrev)
+    {
+        dp.dist2D += dpPrev->dist2D;
+        dp.dist3D += dpPrev->dist3D;
+    }
+
+    mProcessor.rowHeading(dp, dpPrev);
+
+    mRows.append(dp);
+
+    // Slopes need rows on either side
+    const int ready = mProcessor.mSlopes.completeRows(mRows, mRows.size());
+    if (ready - mNext >= Batch) flush(ready, output);
+}
+
+void TrackKernel::finish(
+        QVector< DataPoint > &output)
+{
+    flush(mRows.size(), output);
+}
+
+void TrackKernel::flush(
+        int end,
+        QVector< DataPoint > &output)
+{
+    if (end <= mNext) return;
+
+    mProcessor.mSlopes.compute(mRows, mNext, end, values, numValues, mSlopes);
+
+    const double *slope = mSlopes.constData();
+    for (int i = mNext; i < end; ++i, slope += numValues)
+    {
+        DataPoint dp = mRows[i];
+
+        dp.curv = slope[0];
+        dp.accel = slope[1];
+        dp.omega = slope[2];
+
+        mProcessor.rowAerodynamics(dp, slope + 3, Atmosphere::density(dp.hMSL));
+
+        output.append(dp);
+    }
+
+    mNext = end;
+
+    // Keep the rows still needed for slopes, and the last row for the next
+    // one to be measured from
+    int first = mRows.size() - 1;
+    if (mNext < mRows.size())
+    {
+        first = mProcessor.mSlopes.firstNeeded(mRows, mNext);
+    }
+
+    if (first > 0)
+    {
+        mRows.remove(0, first);
+        mNext -= first;
+    }
+}
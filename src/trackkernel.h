@@ -0,0 +1,48 @@
+#ifndef TRACKKERNEL_H
+#define TRACKKERNEL_H
+
+#include <QVector>
+
+#include "GeographicLib/LocalCartesian.hpp"
+
+#include "datapoint.h"
+#include "trackprocessor.h"
+
+// Computes every derived value of a track in one forward pass, as rows are
+// read. Each row is positioned against the one before it as soon as it is
+// added; it is then held in a short window until the rows within half the
+// slope window after it have arrived, when its slopes, lift and drag are
+// computed and it is moved to the output. Results are the same as
+// TrackProcessor::processAll, bit for bit.
+
+class TrackKernel
+{
+public:
+    explicit TrackKernel(const TrackProcessor &processor);
+
+    // Adds one row as read from the file. Rows whose values are final are
+    // appended to output.
+    void addRow(const DataPoint &dp, QVector< DataPoint > &output);
+
+    // Appends the remaining rows once the last one has been added
+    void finish(QVector< DataPoint > &output);
+
+    // Rows added but not yet appended to an output
+    int pending() const { return mRows.size() - mNext; }
+
+private:
+    // Rows whose slopes are computed together
+    enum { Batch = 64 };
+
+    TrackProcessor                 mProcessor;
+    GeographicLib::LocalCartesian  mProj;
+    bool                           mProjected;
+
+    QVector< DataPoint >           mRows;
+    int                            mNext;
+    QVector< double >              mSlopes;
+
+    void flush(int end, QVector< DataPoint > &output);
+};
+
+#endif // TRACKKERNEL_H
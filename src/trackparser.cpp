@@ -0,0 +1,614 @@
+#include "trackinflater.h"
+#include "trackparser.h"
+
+#include <QDateTime>
+
+#include <limits.h>
+#include <string.h>
+
+// Fields are located with pointers into the mapped file and converted
+// without creating a QString per row or per field. Numbers are converted with
+// a locale-free parser that falls back to QByteArray::toDouble for anything
+// that cannot be converted exactly.
+//
+// The header is compiled into a plan listing the columns to convert in the
+// order they appear, so each row is scanned once and columns that are not
+// needed are skipped without being converted.
+//
+// Compressed files are decompressed by a TrackInflater and parsed from its
+// chunks as they arrive. A line split between chunks is carried over into
+// the next buffer.
+
+TrackParser::TrackParser():
+    mMap(0),
+    mInflater(0),
+    mDiscarded(0),
+    mBegin(0),
+    mData(0),
+    mPos(0),
+    mEnd(0)
+{
+    int columns[colLast];
+    for (int i = 0; i < colLast; ++i)
+    {
+        columns[i] = -1;
+    }
+
+    compilePlan(columns);
+}
+
+TrackParser::~TrackParser()
+{
+    close();
+}
+
+bool TrackParser::open(
+        const QString &fileName)
+{
+    close();
+
+    mFile.setFileName(fileName);
+    if (!mFile.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    if (TrackInflater::isCompressed(fileName))
+    {
+        // Decompress on a separate thread
+        mFile.close();
+
+        mInflater = new TrackInflater(fileName);
+        mInflater->start();
+
+        refill();
+    }
+    else
+    {
+        // Map file into memory, falling back on a buffered read
+        const qint64 size = mFile.size();
+        if (size > 0)
+        {
+            mMap = mFile.map(0, size);
+        }
+
+        if (mMap)
+        {
+            mBegin = (const char *) mMap;
+            mEnd = mBegin + size;
+        }
+        else
+        {
+            mBuffer = mFile.readAll();
+            mBegin = mBuffer.constData();
+            mEnd = mBegin + mBuffer.size();
+        }
+
+        mPos = mBegin;
+    }
+
+    // Skip UTF-8 byte order mark
+    if (mEnd - mPos >= 3 && !memcmp(mPos, "\xEF\xBB\xBF", 3))
+    {
+        mPos += 3;
+    }
+
+    readHeader();
+
+    return true;
+}
+
+void TrackParser::close()
+{
+    if (mMap)
+    {
+        mFile.unmap(mMap);
+        mMap = 0;
+    }
+
+    mFile.close();
+    mBuffer.clear();
+
+    delete mInflater;
+    mInflater = 0;
+
+    mPrevious.clear();
+    mDiscarded = 0;
+
+    mBegin = mData = mPos = mEnd = 0;
+}
+
+bool TrackParser::refill()
+{
+    QByteArray chunk;
+    if (!mInflater || !mInflater->read(chunk))
+    {
+        return false;
+    }
+
+    // Keep the last line returned valid until the next call
+    mPrevious.swap(mBuffer);
+
+    // Carry over the unread part of the buffer
+    mDiscarded += mPos - mBegin;
+    mBuffer = QByteArray(mPos, mEnd - mPos) + chunk;
+
+    mBegin = mData = mPos = mBuffer.constData();
+    mEnd = mBegin + mBuffer.size();
+
+    return true;
+}
+
+const char *TrackParser::nextLine(
+        const char *&lineEnd)
+{
+    const char *eol = (const char *) memchr(mPos, '\n', mEnd - mPos);
+
+    // Lines may continue into the next chunk of a compressed file
+    while (!eol && refill())
+    {
+        eol = (const char *) memchr(mPos, '\n', mEnd - mPos);
+    }
+
+    const char *begin = mPos;
+
+    if (eol)
+    {
+        mPos = eol + 1;
+    }
+    else
+    {
+        mPos = eol = mEnd;
+    }
+
+    // Strip carriage return
+    if (eol > begin && eol[-1] == '\r') --eol;
+
+    // Only report the end once there is nothing left to decompress
+    if (mPos == mEnd) refill();
+
+    lineEnd = eol;
+    return begin;
+}
+
+void TrackParser::readHeader()
+{
+    int columns[colLast];
+    for (int i = 0; i < colLast; ++i)
+    {
+        columns[i] = -1;
+    }
+
+    // Read column labels
+    if (!atEnd())
+    {
+        const char *end;
+        const char *p = nextLine(end);
+
+        for (int i = 0; ; ++i)
+        {
+            const char *comma = (const char *) memchr(p, ',', end - p);
+            const char *fieldEnd = comma ? comma : end;
+            const QByteArray s(p, fieldEnd - p);
+
+            if (s == "time")    columns[Time]  = i;
+            if (s == "lat")     columns[Lat]   = i;
+            if (s == "lon")     columns[Lon]   = i;
+            if (s == "hMSL")    columns[HMSL]  = i;
+            if (s == "velN")    columns[VelN]  = i;
+            if (s == "velE")    columns[VelE]  = i;
+            if (s == "velD")    columns[VelD]  = i;
+            if (s == "hAcc")    columns[HAcc]  = i;
+            if (s == "vAcc")    columns[VAcc]  = i;
+            if (s == "sAcc")    columns[SAcc]  = i;
+            if (s == "numSV")   columns[NumSV] = i;
+
+            if (!comma) break;
+
+            p = comma + 1;
+        }
+    }
+
+    compilePlan(columns);
+
+    // Skip units row
+    if (!atEnd())
+    {
+        const char *end;
+        nextLine(end);
+    }
+
+    mData = mPos;
+}
+
+int TrackParser::readRows(
+        QVector< DataPoint > &data,
+        int maxRows)
+{
+    int rows = 0;
+
+    if (maxRows < 0 && data.isEmpty())
+    {
+        data.reserve(data.size() + estimateRows());
+    }
+
+    DataPoint pt;
+    while ((maxRows < 0 || rows < maxRows) && readRow(pt))
+    {
+        data.append(pt);
+        ++rows;
+    }
+
+    return rows;
+}
+
+bool TrackParser::readRow(
+        DataPoint &pt)
+{
+    while (!atEnd())
+    {
+        const char *end;
+        const char *begin = nextLine(end);
+
+        // Skip blank lines
+        if (begin == end) continue;
+
+        parseRow(begin, end, pt);
+        return true;
+    }
+
+    return false;
+}
+
+bool TrackParser::readLastRow(
+        DataPoint &pt) const
+{
+    if (mInflater) return false;
+
+    // Skip trailing line breaks
+    const char *end = mEnd;
+    while (end > mData && (end[-1] == '\n' || end[-1] == '\r')) --end;
+
+    if (end == mData) return false;
+
+    // Find start of line
+    const char *begin = end;
+    while (begin > mData && begin[-1] != '\n') --begin;
+
+    parseRow(begin, end, pt);
+    return true;
+}
+
+bool TrackParser::seek(
+        qint64 position)
+{
+    if (mInflater) return false;
+
+    if (position < mData - mBegin || position > mEnd - mBegin)
+    {
+        return false;
+    }
+
+    mPos = mBegin + position;
+    return true;
+}
+
+bool TrackParser::seekAfter(
+        qint64 timestamp)
+{
+    if (mInflater) return false;
+
+    // Search backwards for the last row at or before timestamp
+    const char *end = mEnd;
+
+    while (end > mData)
+    {
+        const char *begin = end;
+        if (begin[-1] == '\n') --begin;
+        while (begin > mData && begin[-1] != '\n') --begin;
+
+        const char *lineEnd = end;
+        while (lineEnd > begin && (lineEnd[-1] == '\n' || lineEnd[-1] == '\r')) --lineEnd;
+
+        if (lineEnd > begin)
+        {
+            DataPoint pt;
+            parseRow(begin, lineEnd, pt);
+
+            if (pt.timestamp <= timestamp)
+            {
+                mPos = end;
+                return true;
+            }
+        }
+
+        end = begin;
+    }
+
+    return false;
+}
+
+void TrackParser::excludePartialRow()
+{
+    if (mInflater) return;
+
+    // Stop after the last complete line
+    while (mEnd > mPos && mEnd[-1] != '\n') --mEnd;
+}
+
+bool TrackParser::failed() const
+{
+    // Compressed data ended early or was corrupt
+    return mInflater && atEnd() && mInflater->failed();
+}
+
+int TrackParser::estimateRows() const
+{
+    // Assume remaining rows are as long as the next one
+    const char *eol = (const char *) memchr(mPos, '\n', mEnd - mPos);
+    if (!eol) return atEnd() ? 0 : 1;
+
+    return (mEnd - mPos) / (eol + 1 - mPos) + 1;
+}
+
+double TrackParser::progress() const
+{
+    if (mInflater) return mInflater->progress();
+
+    if (mEnd == mBegin) return 1;
+    return (double) (mPos - mBegin) / (mEnd - mBegin);
+}
+
+void TrackParser::compilePlan(
+        const int *columns)
+{
+    static const Step steps[colLast] = {
+        { Time,  Timestamp, 0,                0 },
+        { Lat,   Double,    &DataPoint::lat,  0 },
+        { Lon,   Double,    &DataPoint::lon,  0 },
+        { HMSL,  Double,    &DataPoint::hMSL, 0 },
+        { VelN,  Double,    &DataPoint::velN, 0 },
+        { VelE,  Double,    &DataPoint::velE, 0 },
+        { VelD,  Double,    &DataPoint::velD, 0 },
+        { HAcc,  Double,    &DataPoint::hAcc, 0 },
+        { VAcc,  Double,    &DataPoint::vAcc, 0 },
+        { SAcc,  Double,    &DataPoint::sAcc, 0 },
+        { NumSV, Integer,   0,                &DataPoint::numSV }
+    };
+
+    // Missing columns sort last and are never reached
+    for (int i = 0; i < colLast; ++i)
+    {
+        mPlan[i] = steps[i];
+        mPlan[i].column = (columns[i] >= 0) ? columns[i] : INT_MAX;
+    }
+
+    // Insertion sort by column
+    for (int i = 1; i < colLast; ++i)
+    {
+        const Step step = mPlan[i];
+
+        int j = i;
+        for (; j > 0 && mPlan[j - 1].column > step.column; --j)
+        {
+            mPlan[j] = mPlan[j - 1];
+        }
+
+        mPlan[j] = step;
+    }
+}
+
+void TrackParser::parseRow(
+        const char *begin,
+        const char *end,
+        DataPoint &pt) const
+{
+    const char *p = begin;
+    int column = 0;
+    int i = 0;
+
+    pt.hasGeodetic = true;
+
+    // Convert needed fields in a single pass
+    for (; i < colLast && p; ++i)
+    {
+        const Step &step = mPlan[i];
+
+        // Skip fields that aren't needed
+        while (p && column < step.column)
+        {
+            p = (const char *) memchr(p, ',', end - p);
+            if (p) ++p;
+            ++column;
+        }
+
+        if (!p) break;
+
+        const char *comma = (const char *) memchr(p, ',', end - p);
+        convert(step, p, comma ? comma : end, pt);
+
+        p = comma ? comma + 1 : 0;
+        ++column;
+    }
+
+    // Missing fields are treated as empty
+    for (; i < colLast; ++i)
+    {
+        convert(mPlan[i], end, end, pt);
+    }
+}
+
+void TrackParser::convert(
+        const Step &step,
+        const char *begin,
+        const char *end,
+        DataPoint &pt)
+{
+    switch (step.converter)
+    {
+    case Timestamp:
+        pt.timestamp = parseTimestamp(begin, end);
+        break;
+    case Double:
+        pt.*step.value = parseDouble(begin, end);
+        break;
+    case Integer:
+        pt.*step.integer = parseDouble(begin, end);
+        break;
+    }
+}
+
+double TrackParser::parseDouble(
+        const char *begin,
+        const char *end)
+{
+    // Exact powers of ten for the fast path
+    static const double powers[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+        1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+        1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    const char *p = begin;
+
+    // Trim whitespace
+    while (p < end && (*p == ' ' || *p == '\t')) ++p;
+    while (end > p && (end[-1] == ' ' || end[-1] == '\t')) --end;
+
+    if (p == end) return 0;
+
+    bool negative = false;
+    if (*p == '-' || *p == '+')
+    {
+        negative = (*p == '-');
+        ++p;
+    }
+
+    quint64 mantissa = 0;
+    int exponent = 0;
+    int digits = 0;
+    bool valid = false;
+
+    // Integer part
+    while (p < end && *p >= '0' && *p <= '9')
+    {
+        mantissa = mantissa * 10 + (*p - '0');
+        if (mantissa) ++digits;
+        valid = true;
+        ++p;
+    }
+
+    // Fractional part
+    if (p < end && *p == '.')
+    {
+        ++p;
+        while (p < end && *p >= '0' && *p <= '9')
+        {
+            mantissa = mantissa * 10 + (*p - '0');
+            if (mantissa) ++digits;
+            --exponent;
+            valid = true;
+            ++p;
+        }
+    }
+
+    // A decimal mantissa below 2^53 and a power of ten up to 1e22 are both
+    // exact, so a single multiplication or division is correctly rounded
+    if (valid && p == end && digits <= 15 && exponent >= -22)
+    {
+        double value = (double) mantissa;
+        if (exponent < 0) value /= powers[-exponent];
+        return negative ? -value : value;
+    }
+
+    // Exponents, long mantissas and invalid input
+    return QByteArray(begin, end - begin).toDouble();
+}
+
+static bool parseDigits(
+        const char *p,
+        int count,
+        int &value)
+{
+    value = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        if (p[i] < '0' || p[i] > '9') return false;
+        value = value * 10 + (p[i] - '0');
+    }
+    return true;
+}
+
+static qint64 daysFromCivil(
+        int year,
+        int month,
+        int day)
+{
+    // Days since 1970-01-01 in the proleptic Gregorian calendar
+    year -= (month <= 2);
+    const int era = (year >= 0 ? year : year - 399) / 400;
+    const int yoe = year - era * 400;
+    const int doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return (qint64) era * 146097 + doe - 719468;
+}
+
+qint64 TrackParser::parseTimestamp(
+        const char *begin,
+        const char *end)
+{
+    // Fixed FlySight format: YYYY-MM-DDThh:mm:ss.sssZ with any number of
+    // fractional digits
+    const char *p = begin;
+
+    int year, month, day, hour, minute, second;
+    if (end - p >= 20
+            && parseDigits(p, 4, year) && p[4] == '-'
+            && parseDigits(p + 5, 2, month) && p[7] == '-'
+            && parseDigits(p + 8, 2, day) && p[10] == 'T'
+            && parseDigits(p + 11, 2, hour) && p[13] == ':'
+            && parseDigits(p + 14, 2, minute) && p[16] == ':'
+            && parseDigits(p + 17, 2, second)
+            && month >= 1 && month <= 12 && day >= 1 && day <= 31
+            && hour < 24 && minute < 60 && second < 60)
+    {
+        p += 19;
+
+        // Fraction rounded to the nearest millisecond, which may carry into
+        // the next second
+        int msec = 0;
+        if (p < end && *p == '.')
+        {
+            int scale = 1000;
+            int digits = 0;
+            int next = 0;
+
+            for (++p; p < end && *p >= '0' && *p <= '9'; ++p, ++digits)
+            {
+                if (digits < 3)
+                {
+                    scale /= 10;
+                    msec += (*p - '0') * scale;
+                }
+                else if (digits == 3)
+                {
+                    next = *p - '0';
+                }
+            }
+
+            if (next >= 5) ++msec;
+        }
+
+        if (p + 1 == end && *p == 'Z')
+        {
+            const qint64 days = daysFromCivil(year, month, day);
+            return ((days * 24 + hour) * 60 + minute) * 60000
+                    + second * 1000 + msec;
+        }
+    }
+
+    // Anything else is left to Qt
+    const QDateTime dateTime = QDateTime::fromString(
+                QString::fromLatin1(begin, end - begin), Qt::ISODate);
+    return dateTime.isValid() ? dateTime.toMSecsSinceEpoch() : 0;
+}
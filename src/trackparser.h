@@ -0,0 +1,103 @@
+#ifndef TRACKPARSER_H
+#define TRACKPARSER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+#include "datapoint.h"
+
+class TrackInflater;
+
+class TrackParser
+{
+public:
+    TrackParser();
+    ~TrackParser();
+
+    bool open(const QString &fileName);
+    void close();
+
+    int readRows(QVector< DataPoint > &data, int maxRows = -1);
+    bool readRow(DataPoint &pt);
+    bool readLastRow(DataPoint &pt) const;
+
+    bool atEnd() const { return mPos >= mEnd; }
+
+    // Compressed files are read as a stream, so readLastRow and seeking are
+    // not available
+    bool isCompressed() const { return mInflater != 0; }
+    bool failed() const;
+
+    // Resume reading a file that is still being written
+    qint64 position() const { return mDiscarded + (mPos - mBegin); }
+    bool seek(qint64 position);
+    bool seekAfter(qint64 timestamp);
+    void excludePartialRow();
+
+    int estimateRows() const;
+    double progress() const;
+
+    static double parseDouble(const char *begin, const char *end);
+    static qint64 parseTimestamp(const char *begin, const char *end);
+
+private:
+    // Column enumeration
+    typedef enum {
+        Time = 0,
+        Lat,
+        Lon,
+        HMSL,
+        VelN,
+        VelE,
+        VelD,
+        HAcc,
+        VAcc,
+        SAcc,
+        NumSV,
+        colLast
+    } Columns;
+
+    QFile       mFile;
+    uchar      *mMap;
+    QByteArray  mBuffer;
+
+    TrackInflater *mInflater;
+    QByteArray     mPrevious;
+    qint64         mDiscarded;
+
+    const char *mBegin;
+    const char *mData;
+    const char *mPos;
+    const char *mEnd;
+
+    // Conversion of one field into a DataPoint member
+    typedef enum {
+        Timestamp,
+        Double,
+        Integer
+    } Converter;
+
+    typedef struct {
+        int               column;
+        Converter         converter;
+        double DataPoint::*value;
+        int    DataPoint::*integer;
+    } Step;
+
+    // Steps in column order, with missing columns last
+    Step        mPlan[colLast];
+
+    const char *nextLine(const char *&lineEnd);
+    bool refill();
+
+    void readHeader();
+    void compilePlan(const int *columns);
+    void parseRow(const char *begin, const char *end, DataPoint &pt) const;
+
+    static void convert(const Step &step, const char *begin, const char *end,
+                        DataPoint &pt);
+};
+
+#endif // TRACKPARSER_H
@@ -0,0 +1,807 @@
+#include "trackprocessor.h"
+
+#include <QPair>
+#include <QThreadPool>
+#include <QtConcurrentMap>
+
+#include <math.h>
+
+#include "GeographicLib/Geodesic.hpp"
+#include "GeographicLib/LocalCartesian.hpp"
+
+#include "atmosphere.h"
+#include "common.h"
+#include "trackstore.h"
+
+using namespace GeographicLib;
+
+namespace
+{
+
+// One stage of processing for a chunk of rows
+class StageRunner
+{
+public:
+    typedef void (TrackProcessor::*Stage)(QVector< DataPoint > &, int, int) const;
+
+    StageRunner(const TrackProcessor *processor, Stage stage,
+                QVector< DataPoint > *data):
+        mProcessor(processor), mStage(stage), mData(data) {}
+
+    void operator()(const QPair< int, int > &chunk) const
+    {
+        (mProcessor->*mStage)(*mData, chunk.first, chunk.second);
+    }
+
+private:
+    const TrackProcessor *mProcessor;
+    Stage                 mStage;
+    QVector< DataPoint > *mData;
+};
+
+// First row with a timestamp not less than timestamp
+int lowerBound(
+        const TrackStore &track,
+        qint64 timestamp)
+{
+    int below = -1, above = track.size();
+
+    while (below + 1 != above)
+    {
+        const int mid = (below + above) / 2;
+
+        if (track.timestamp(mid) < timestamp) below = mid;
+        else                                  above = mid;
+    }
+
+    return above;
+}
+
+}
+
+TrackProcessor::TrackProcessor():
+    mWindAdjustment(false),
+    mWindE(0),
+    mWindN(0),
+    mMass(70),
+    mPlanformArea(2),
+    mGroundReference(0),
+    mTimeReference(0),
+    mExactGeodesic(false),
+    mParallel(false),
+    mOffsetT(0),
+    mOffsetX(0),
+    mOffsetY(0),
+    mOffsetZ(0),
+    mOffsetTheta(0)
+{
+    mOrigin.hasGeodetic = false;
+    mOrigin.x = mOrigin.y = 0;
+}
+
+void TrackProcessor::setWind(
+        bool adjust,
+        double windE,
+        double windN)
+{
+    mWindAdjustment = adjust;
+    mWindE = windE;
+    mWindN = windN;
+}
+
+void TrackProcessor::setAerodynamics(
+        double mass,
+        double planformArea)
+{
+    mMass = mass;
+    mPlanformArea = planformArea;
+}
+
+void TrackProcessor::setGround(
+        double reference)
+{
+    mGroundReference = reference;
+}
+
+void TrackProcessor::setTimeReference(
+        qint64 timestamp)
+{
+    mTimeReference = timestamp;
+}
+
+void TrackProcessor::setOrigin(
+        const DataPoint &dp0)
+{
+    mOrigin = dp0;
+}
+
+void TrackProcessor::setExactGeodesic(
+        bool exact)
+{
+    mExactGeodesic = exact;
+}
+
+void TrackProcessor::setSlopeWindow(
+        double window)
+{
+    mSlopes.setWindow(window);
+}
+
+void TrackProcessor::setParallel(
+        bool parallel)
+{
+    mParallel = parallel;
+}
+
+void TrackProcessor::setReference(
+        const DataPoint &dp0,
+        bool automaticGround)
+{
+    if (automaticGround)
+    {
+        mGroundReference = dp0.hMSL;
+    }
+
+    mTimeReference = dp0.timestamp;
+    mOrigin = dp0;
+}
+
+bool TrackProcessor::sameSettings(
+        const TrackProcessor &other) const
+{
+    return mWindAdjustment == other.mWindAdjustment
+            && mWindE == other.mWindE
+            && mWindN == other.mWindN
+            && mMass == other.mMass
+            && mPlanformArea == other.mPlanformArea
+            && mGroundReference == other.mGroundReference
+            && mExactGeodesic == other.mExactGeodesic
+            && mSlopes.window() == other.mSlopes.window();
+}
+
+void TrackProcessor::initTime(
+        QVector< DataPoint > &data,
+        int begin,
+        int end) const
+{
+    for (int i = begin; i < end; ++i)
+    {
+        rowTime(data[i]);
+    }
+}
+
+void TrackProcessor::initAltitude(
+        QVector< DataPoint > &data,
+        int begin,
+        int end) const
+{
+    for (int i = begin; i < end; ++i)
+    {
+        rowAltitude(data[i]);
+    }
+}
+
+void TrackProcessor::updatePosition(
+        QVector< DataPoint > &data,
+        int begin,
+        int end) const
+{
+    run(&TrackProcessor::initPosition, data, begin, end);
+    run(&TrackProcessor::initVelocity, data, begin, end);
+    initDistance(data, begin, end);
+    initHeading(data, begin, end);
+}
+
+void TrackProcessor::run(
+        Stage stage,
+        QVector< DataPoint > &data,
+        int begin,
+        int end) const
+{
+    const int threads = QThreadPool::globalInstance()->maxThreadCount();
+
+    if (!mParallel || threads < 2 || end - begin < 2 * MinChunk)
+    {
+        (this->*stage)(data, begin, end);
+        return;
+    }
+
+    // A few chunks per thread to even out the load. Each stage only writes
+    // its own rows; rows it reads around a chunk were finished by an earlier
+    // stage, so the result does not depend on how rows are split.
+    const int size = qMax((int) MinChunk, (end - begin + 4 * threads - 1) / (4 * threads));
+
+    QVector< QPair< int, int > > chunks;
+    for (int i = begin; i < end; i += size)
+    {
+        chunks.append(qMakePair(i, qMin(i + size, end)));
+    }
+
+    // Threads write rows in place, so they must not be shared
+    data.detach();
+
+    QtConcurrent::blockingMap(chunks, StageRunner(this, stage, &data));
+}
+
+void TrackProcessor::initPosition(
+        QVector< DataPoint > &data,
+        int begin,
+        int end) const
+{
+    if (!projected())
+    {
+        for (int i = begin; i < end; ++i)
+        {
+            rowPosition(data[i], 0);
+        }
+    }
+    else
+    {
+        const LocalCartesian proj(mOrigin.lat, mOrigin.lon, 0);
+
+        for (int i = begin; i < end; ++i)
+        {
+            rowPosition(data[i], &proj);
+        }
+    }
+}
+
+void TrackProcessor::rowPosition(
+        DataPoint &dp,
+        const LocalCartesian *proj) const
+{
+    if (proj)
+    {
+        // East and north in the tangent plane at the origin. Both ends are
+        // taken on the ellipsoid so altitude does not scale the result, which
+        // is within a few centimetres of the geodesic values out to 20 km.
+        double up;
+        proj->Forward(dp.lat, dp.lon, 0, dp.x, dp.y, up);
+    }
+    else
+    {
+        // Two geodesic inverse solutions
+        double distance = getDistance(mOrigin, dp);
+        double bearing = getBearing(mOrigin, dp);
+
+        dp.x = distance * sin(bearing);
+        dp.y = distance * cos(bearing);
+    }
+
+    // Drift with the wind
+    dp.x += mOffsetX - effectiveWindE() * dp.t;
+    dp.y += mOffsetY - effectiveWindN() * dp.t;
+}
+
+void TrackProcessor::driftPosition(
+        QVector< DataPoint > &data,
+        int begin,
+        int end,
+        double windE,
+        double windN) const
+{
+    for (int i = begin; i < end; ++i)
+    {
+        DataPoint &dp = data[i];
+
+        dp.x -= windE * dp.t;
+        dp.y -= windN * dp.t;
+    }
+}
+
+void TrackProcessor::initVelocity(
+        QVector< DataPoint > &data,
+        int begin,
+        int end) const
+{
+    for (int i = begin; i < end; ++i)
+    {
+        rowVelocity(data[i]);
+    }
+}
+
+void TrackProcessor::initDistance(
+        QVector< DataPoint > &data,
+        int begin,
+        int end) const
+{
+    // Steps between rows, which can be split across threads
+    run(&TrackProcessor::initSteps, data, begin, end);
+
+    // Running sums in order, so they are rounded the same way however the
+    // steps were computed
+    double dist2D = 0, dist3D = 0;
+
+    if (begin > 0)
+    {
+        dist2D = data[begin - 1].dist2D;
+        dist3D = data[begin - 1].dist3D;
+    }
+
+    for (int i = begin; i < end; ++i)
+    {
+        DataPoint &dp = data[i];
+
+        dist2D += dp.dist2D;
+        dist3D += dp.dist3D;
+
+        dp.dist2D = dist2D;
+        dp.dist3D = dist3D;
+    }
+}
+
+void TrackProcessor::initSteps(
+        QVector< DataPoint > &data,
+        int begin,
+        int end) const
+{
+    for (int i = begin; i < end; ++i)
+    {
+        rowStep(data[i], (i > 0) ? &data[i - 1] : 0);
+    }
+}
+
+void TrackProcessor::rowStep(
+        DataPoint &dp,
+        const DataPoint *dpPrev)
+{
+    // Distance from the previous row
+    if (dpPrev)
+    {
+        double dx = dp.x - dpPrev->x;
+        double dy = dp.y - dpPrev->y;
+        double dh = sqrt(dx * dx + dy * dy);
+        double dz = dp.hMSL - dpPrev->hMSL;
+
+        dp.dist2D = dh;
+        dp.dist3D = sqrt(dh * dh + dz * dz);
+    }
+    else
+    {
+        dp.dist2D = dp.dist3D = 0;
+    }
+}
+
+void TrackProcessor::initHeading(
+        QVector< DataPoint > &data,
+        int begin,
+        int end) const
+{
+    // Heading of each row, which can be split across threads
+    run(&TrackProcessor::initRawHeading, data, begin, end);
+
+    // Cumulative heading, in order since each row depends on the one before
+    for (int i = begin; i < end; ++i)
+    {
+        rowHeading(data[i], (i > 0) ? &data[i - 1] : 0);
+    }
+}
+
+void TrackProcessor::initRawHeading(
+        QVector< DataPoint > &data,
+        int begin,
+        int end) const
+{
+    for (int i = begin; i < end; ++i)
+    {
+        rowRawHeading(data[i]);
+    }
+}
+
+void TrackProcessor::rowRawHeading(
+        DataPoint &dp)
+{
+    // Calculate heading
+    dp.heading = atan2(dp.vx, dp.vy) / PI * 180;
+
+    // Calculate heading accuracy
+    const double s = DataPoint::totalSpeed(dp);
+    if (s != 0) dp.cAcc = dp.sAcc / s;
+    else        dp.cAcc = 0;
+}
+
+void TrackProcessor::rowHeading(
+        DataPoint &dp,
+        const DataPoint *dpPrev) const
+{
+    // Adjust heading
+    if (dpPrev)
+    {
+        const double prevHeading = dpPrev->heading;
+
+        while (dp.heading <  prevHeading - 180) dp.heading += 360;
+        while (dp.heading >= prevHeading + 180) dp.heading -= 360;
+    }
+
+    // Relative heading
+    dp.theta = dp.heading + mOffsetTheta;
+}
+
+void TrackProcessor::updateSlopes(
+        QVector< DataPoint > &data,
+        int begin,
+        int end) const
+{
+    initSlopes(data, begin, end, Slopes | CourseRate);
+}
+
+void TrackProcessor::initSlopes(
+        QVector< DataPoint > &data,
+        int begin,
+        int end,
+        int columns) const
+{
+    DerivativeEngine::Value values[3];
+    double DataPoint::*slopes[3];
+    int numValues = 0;
+
+    // Requested slopes in a single pass
+    if (columns & Slopes)
+    {
+        values[numValues] = DataPoint::diveAngle;
+        slopes[numValues++] = &DataPoint::curv;
+
+        values[numValues] = DataPoint::totalSpeed;
+        slopes[numValues++] = &DataPoint::accel;
+    }
+
+    if (columns & CourseRate)
+    {
+        values[numValues] = DataPoint::course;
+        slopes[numValues++] = &DataPoint::omega;
+    }
+
+    if (numValues > 0)
+    {
+        mSlopes.update(data, begin, end, values, slopes, numValues);
+    }
+}
+
+void TrackProcessor::initAerodynamics(
+        QVector< DataPoint > &data,
+        int begin,
+        int end) const
+{
+    static const DerivativeEngine::Value values[] = {
+        DataPoint::northSpeed,
+        DataPoint::eastSpeed,
+        DataPoint::verticalSpeed
+    };
+
+    // Acceleration
+    QVector< double > accel;
+    mSlopes.compute(data, begin, end, values, 3, accel);
+
+    // Air density for the whole range at once
+    QVector< double > hMSL(end - begin), density(end - begin);
+    for (int i = begin; i < end; ++i)
+    {
+        hMSL[i - begin] = data[i].hMSL;
+    }
+
+    Atmosphere::density(hMSL.constData(), density.data(), density.size());
+
+    for (int i = begin; i < end; ++i)
+    {
+        rowAerodynamics(data[i], accel.constData() + (i - begin) * 3,
+                        density[i - begin]);
+    }
+}
+
+void TrackProcessor::rowAerodynamics(
+        DataPoint &dp,
+        const double *accel,
+        double density) const
+{
+    double accelN = accel[0];
+    double accelE = accel[1];
+    double accelD = accel[2];
+
+    // Subtract acceleration due to gravity
+    accelD -= A_GRAVITY;
+
+    // Calculate acceleration due to drag
+    const double vel = DataPoint::totalSpeed(dp);
+    const double proj = (accelN * dp.vy + accelE * dp.vx + accelD * dp.velD) / vel;
+
+    const double dragN = proj * dp.vy / vel;
+    const double dragE = proj * dp.vx / vel;
+    const double dragD = proj * dp.velD / vel;
+
+    const double accelDrag = sqrt(dragN * dragN + dragE * dragE + dragD * dragD);
+
+    // Calculate acceleration due to lift
+    const double liftN = accelN - dragN;
+    const double liftE = accelE - dragE;
+    const double liftD = accelD - dragD;
+
+    const double accelLift = sqrt(liftN * liftN + liftE * liftE + liftD * liftD);
+
+    // From https://en.wikipedia.org/wiki/Dynamic_pressure
+    const double dynamicPressure = density * vel * vel / 2;
+
+    // Calculate lift and drag coefficients
+    dp.lift = mMass * accelLift / dynamicPressure / mPlanformArea;
+    dp.drag = mMass * accelDrag / dynamicPressure / mPlanformArea;
+}
+
+void TrackProcessor::processAll(
+        QVector< DataPoint > &data) const
+{
+    const int size = data.size();
+
+    run(&TrackProcessor::initTime, data, 0, size);
+    run(&TrackProcessor::initAltitude, data, 0, size);
+    updatePosition(data, 0, size);
+    run(&TrackProcessor::updateSlopes, data, 0, size);
+    run(&TrackProcessor::initAerodynamics, data, 0, size);
+}
+
+int TrackProcessor::changedColumns(
+        const TrackProcessor &previous) const
+{
+    int columns = 0;
+
+    if (mTimeReference != previous.mTimeReference)
+    {
+        columns |= Time;
+    }
+
+    if (mGroundReference != previous.mGroundReference)
+    {
+        columns |= Altitude;
+    }
+
+    if (!sameProjection(previous))
+    {
+        columns |= Position;
+    }
+
+    if (effectiveWindE() != previous.effectiveWindE()
+            || effectiveWindN() != previous.effectiveWindN())
+    {
+        columns |= Position | Velocity;
+    }
+
+    if (mMass != previous.mMass
+            || mPlanformArea != previous.mPlanformArea)
+    {
+        columns |= Aerodynamics;
+    }
+
+    if (mSlopes.window() != previous.mSlopes.window())
+    {
+        columns |= Slopes | CourseRate | Aerodynamics;
+    }
+
+    return dependentColumns(columns);
+}
+
+int TrackProcessor::dependentColumns(
+        int columns)
+{
+    // Columns computed directly from each column, in the order they are
+    // computed, so one pass finds everything downstream
+    static const struct {
+        int column;
+        int dependents;
+    } graph[] = {
+        { Time,     Position | Slopes | CourseRate | Aerodynamics },
+        { Position, Distance },
+        { Velocity, Heading | Slopes | Aerodynamics },
+        { Heading,  CourseRate }
+    };
+
+    for (unsigned i = 0; i < sizeof(graph) / sizeof(graph[0]); ++i)
+    {
+        if (columns & graph[i].column)
+        {
+            columns |= graph[i].dependents;
+        }
+    }
+
+    return columns;
+}
+
+void TrackProcessor::update(
+        QVector< DataPoint > &data,
+        const TrackProcessor &previous) const
+{
+    const int columns = changedColumns(previous);
+    const int size = data.size();
+
+    updateRows(data, 0, size, columns, previous);
+    updateWindowed(data, 0, size, columns);
+}
+
+void TrackProcessor::processAll(
+        TrackStore &track) const
+{
+    // Compared with itself, only a change of time gives new positions
+    updateBlocks(track, AllColumns, *this);
+}
+
+void TrackProcessor::update(
+        TrackStore &track,
+        const TrackProcessor &previous) const
+{
+    const int columns = changedColumns(previous);
+    if (columns) updateBlocks(track, columns, previous);
+}
+
+void TrackProcessor::updateRows(
+        QVector< DataPoint > &data,
+        int begin,
+        int end,
+        int columns,
+        const TrackProcessor &previous) const
+{
+    if (columns & Time) run(&TrackProcessor::initTime, data, begin, end);
+    if (columns & Altitude) run(&TrackProcessor::initAltitude, data, begin, end);
+
+    if (columns & Position)
+    {
+        if (sameProjection(previous) && !(columns & Time))
+        {
+            // Only the wind has changed, so move rows by the difference
+            driftPosition(data, begin, end,
+                          effectiveWindE() - previous.effectiveWindE(),
+                          effectiveWindN() - previous.effectiveWindN());
+        }
+        else
+        {
+            run(&TrackProcessor::initPosition, data, begin, end);
+        }
+    }
+
+    if (columns & Velocity) run(&TrackProcessor::initVelocity, data, begin, end);
+    if (columns & Distance) initDistance(data, begin, end);
+    if (columns & Heading) initHeading(data, begin, end);
+}
+
+void TrackProcessor::updateWindowed(
+        QVector< DataPoint > &data,
+        int begin,
+        int end,
+        int columns) const
+{
+    // Slopes and course rate always change together
+    if (columns & (Slopes | CourseRate)) run(&TrackProcessor::updateSlopes, data, begin, end);
+
+    if (columns & Aerodynamics) run(&TrackProcessor::initAerodynamics, data, begin, end);
+}
+
+void TrackProcessor::updateBlocks(
+        TrackStore &track,
+        int columns,
+        const TrackProcessor &previous) const
+{
+    const int size = track.size();
+
+    // Rows read around a block cover two slope windows on either side, found
+    // from timestamps since times may be about to change: slopes for the
+    // first rows start from the bucket before them. Two more rows allow for
+    // the row on either side each window always includes.
+    const qint64 margin = (qint64) ceil(2 * mSlopes.window() * 1000);
+
+    for (int begin = 0; begin < size; begin += BlockRows)
+    {
+        const int end = qMin(begin + BlockRows, size);
+
+        const int lo = qMax(0, lowerBound(track, track.timestamp(begin) - margin) - 2);
+        const int hi = qMin(size, lowerBound(track, track.timestamp(end - 1) + margin + 1) + 2);
+
+        QVector< DataPoint > rows = track.rawRows(lo, hi);
+
+        // Rows before the block were written with the previous one. Rows
+        // after it are processed again with the next.
+        updateRows(rows, begin - lo, hi - lo, columns, previous);
+        updateWindowed(rows, begin - lo, end - lo, columns);
+
+        track.setRows(begin, rows.mid(begin - lo, end - begin));
+    }
+}
+
+bool TrackProcessor::sameProjection(
+        const TrackProcessor &other) const
+{
+    if (mExactGeodesic != other.mExactGeodesic) return false;
+    if (mOrigin.hasGeodetic != other.mOrigin.hasGeodetic) return false;
+
+    if (mOrigin.hasGeodetic)
+    {
+        return mOrigin.lat == other.mOrigin.lat
+                && mOrigin.lon == other.mOrigin.lon;
+    }
+    else
+    {
+        return mOrigin.x == other.mOrigin.x
+                && mOrigin.y == other.mOrigin.y;
+    }
+}
+
+void TrackProcessor::alignTo(
+        const DataPoint &dp)
+{
+    mOffsetT = mOffsetX = mOffsetY = mOffsetZ = mOffsetTheta = 0;
+
+    // Process a copy of the row from its raw values
+    QVector< DataPoint > row(1, dp);
+
+    initTime(row, 0, 1);
+    initAltitude(row, 0, 1);
+
+    mOffsetT = dp.t - row[0].t;
+    mOffsetZ = dp.z - row[0].z;
+
+    // Wind adjustment uses the current time
+    row[0].t = dp.t;
+    updatePosition(row, 0, 1);
+
+    mOffsetX = dp.x - row[0].x;
+    mOffsetY = dp.y - row[0].y;
+
+    mOffsetTheta = dp.theta - dp.heading;
+}
+
+void TrackProcessor::appendRows(
+        QVector< DataPoint > &data,
+        int begin,
+        int end)
+{
+    if (begin > 0)
+    {
+        alignTo(data[begin - 1]);
+    }
+
+    run(&TrackProcessor::initTime, data, begin, end);
+    run(&TrackProcessor::initAltitude, data, begin, end);
+    updatePosition(data, begin, end);
+
+    // Slopes of earlier rows may use the new ones
+    const int first = mSlopes.firstAffected(data, begin);
+
+    run(&TrackProcessor::updateSlopes, data, first, end);
+    run(&TrackProcessor::initAerodynamics, data, first, end);
+}
+
+int TrackProcessor::completeRows(
+        const QVector< DataPoint > &data,
+        int end) const
+{
+    return mSlopes.completeRows(data, end);
+}
+
+double TrackProcessor::getDistance(
+        const DataPoint &dp1,
+        const DataPoint &dp2)
+{
+    if (dp1.hasGeodetic && dp2.hasGeodetic)
+    {
+        const Geodesic &geod = Geodesic::WGS84();
+        double s12;
+
+        geod.Inverse(dp1.lat, dp1.lon, dp2.lat, dp2.lon, s12);
+
+        return s12;
+    }
+    else
+    {
+        const double dx = dp2.x - dp1.x;
+        const double dy = dp2.y - dp1.y;
+
+        return sqrt(dx * dx + dy * dy);
+    }
+}
+
+double TrackProcessor::getBearing(
+        const DataPoint &dp1,
+        const DataPoint &dp2)
+{
+    const Geodesic &geod = Geodesic::WGS84();
+    double azi1, azi2;
+
+    geod.Inverse(dp1.lat, dp1.lon, dp2.lat, dp2.lon, azi1, azi2);
+
+    return azi1 / 180 * PI;
+}
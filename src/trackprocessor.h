@@ -0,0 +1,212 @@
+#ifndef TRACKPROCESSOR_H
+#define TRACKPROCESSOR_H
+
+#include <QMetaType>
+#include <QVector>
+
+#include "datapoint.h"
+#include "derivativeengine.h"
+
+namespace GeographicLib {
+class LocalCartesian;
+}
+
+class TrackStore;
+
+// Computes derived values for a range [begin, end) of a track. Rows before
+// begin must already be processed, so a track can be handled in pieces as
+// it is read.
+
+class TrackProcessor
+{
+public:
+    // Groups of derived values, in the order they are computed
+    typedef enum {
+        Time         = 0x0001,  // t
+        Altitude     = 0x0002,  // z
+        Position     = 0x0004,  // x, y
+        Velocity     = 0x0008,  // vx, vy
+        Distance     = 0x0010,  // dist2D, dist3D
+        Heading      = 0x0020,  // heading, theta, cAcc
+        Slopes       = 0x0040,  // curv, accel
+        CourseRate   = 0x0080,  // omega
+        Aerodynamics = 0x0100   // lift, drag
+    } Column;
+
+    enum { AllColumns = 0x01ff };
+
+    TrackProcessor();
+
+    void setWind(bool adjust, double windE, double windN);
+    void setAerodynamics(double mass, double planformArea);
+    void setGround(double reference);
+    void setTimeReference(qint64 timestamp);
+    void setOrigin(const DataPoint &dp0);
+
+    // Horizontal position from geodesic distance and bearing to the origin
+    // instead of the local tangent plane. Much slower, but useful to
+    // validate the projection.
+    void setExactGeodesic(bool exact);
+
+    // Length in seconds of the window used for slopes
+    void setSlopeWindow(double window);
+
+    // Split long ranges into chunks processed on all cores. Results are the
+    // same as processing serially, bit for bit.
+    void setParallel(bool parallel);
+
+    // Time and position relative to a reference row, normally the last one,
+    // optionally using its altitude as ground level
+    void setReference(const DataPoint &dp0, bool automaticGround);
+
+    bool windAdjustment() const { return mWindAdjustment; }
+    double windE() const { return mWindE; }
+    double windN() const { return mWindN; }
+
+    double mass() const { return mMass; }
+    double planformArea() const { return mPlanformArea; }
+
+    double groundReference() const { return mGroundReference; }
+    bool exactGeodesic() const { return mExactGeodesic; }
+    double slopeWindow() const { return mSlopes.window(); }
+    bool parallel() const { return mParallel; }
+    qint64 timeReference() const { return mTimeReference; }
+    const DataPoint &origin() const { return mOrigin; }
+
+    bool sameSettings(const TrackProcessor &other) const;
+
+    void initTime(QVector< DataPoint > &data, int begin, int end) const;
+    void initAltitude(QVector< DataPoint > &data, int begin, int end) const;
+
+    // Position, velocity, distance and heading. Horizontal position is
+    // projected onto the plane tangent to the ellipsoid below the origin.
+    void updatePosition(QVector< DataPoint > &data, int begin, int end) const;
+
+    // Curvature, acceleration and course rate. Each row needs the rows
+    // within half the slope window on either side of it.
+    void updateSlopes(QVector< DataPoint > &data, int begin, int end) const;
+
+    // Lift and drag coefficients, with the same requirements as updateSlopes
+    void initAerodynamics(QVector< DataPoint > &data, int begin, int end) const;
+
+    // All of the above for a complete track
+    void processAll(QVector< DataPoint > &data) const;
+
+    // Columns whose inputs differ from those of the processor that computed
+    // a track, together with every column computed from them
+    int changedColumns(const TrackProcessor &previous) const;
+    static int dependentColumns(int columns);
+
+    // Recompute only the changed columns of a complete track
+    void update(QVector< DataPoint > &data,
+                const TrackProcessor &previous) const;
+
+    // As above for a track stored in columns. Rows are processed a block at
+    // a time, so only one block and the rows around it are held as rows.
+    void processAll(TrackStore &track) const;
+    void update(TrackStore &track, const TrackProcessor &previous) const;
+
+    // Match the time, position, altitude and course of an existing row, which
+    // may have been moved since it was processed (e.g. by setting the zero
+    // point). Rows processed afterwards continue in the same frame.
+    void alignTo(const DataPoint &dp);
+
+    // Rows [begin, end) appended to a processed track. Slopes are also
+    // updated for rows before begin whose window reaches the new rows.
+    void appendRows(QVector< DataPoint > &data, int begin, int end);
+
+    // Number of leading rows of a partial track whose slopes are final
+    int completeRows(const QVector< DataPoint > &data, int end) const;
+
+    static double getDistance(const DataPoint &dp1, const DataPoint &dp2);
+    static double getBearing(const DataPoint &dp1, const DataPoint &dp2);
+
+private:
+    friend class TrackKernel;
+
+    typedef void (TrackProcessor::*Stage)(QVector< DataPoint > &, int, int) const;
+
+    // Smallest chunk worth handing to another thread
+    enum { MinChunk = 4096 };
+
+    // Rows of a TrackStore processed at a time
+    enum { BlockRows = 65536 };
+
+    void run(Stage stage, QVector< DataPoint > &data, int begin, int end) const;
+
+    void initPosition(QVector< DataPoint > &data, int begin, int end) const;
+    void driftPosition(QVector< DataPoint > &data, int begin, int end,
+                       double windE, double windN) const;
+    void initVelocity(QVector< DataPoint > &data, int begin, int end) const;
+    void initDistance(QVector< DataPoint > &data, int begin, int end) const;
+    void initSteps(QVector< DataPoint > &data, int begin, int end) const;
+    void initHeading(QVector< DataPoint > &data, int begin, int end) const;
+    void initRawHeading(QVector< DataPoint > &data, int begin, int end) const;
+    void initSlopes(QVector< DataPoint > &data, int begin, int end,
+                    int columns) const;
+
+    // Changed columns of rows [begin, end), first those computed from each
+    // row and the one before it, then those computed over the slope window
+    void updateRows(QVector< DataPoint > &data, int begin, int end,
+                    int columns, const TrackProcessor &previous) const;
+    void updateWindowed(QVector< DataPoint > &data, int begin, int end,
+                        int columns) const;
+
+    void updateBlocks(TrackStore &track, int columns,
+                      const TrackProcessor &previous) const;
+
+    // Values of a single row, shared with TrackKernel
+    void rowTime(DataPoint &dp) const
+    {
+        dp.t = (double) (dp.timestamp - mTimeReference) / 1000 + mOffsetT;
+    }
+    void rowAltitude(DataPoint &dp) const
+    {
+        dp.z = dp.hMSL - mGroundReference + mOffsetZ;
+    }
+    void rowVelocity(DataPoint &dp) const
+    {
+        dp.vx = dp.velE - effectiveWindE();
+        dp.vy = dp.velN - effectiveWindN();
+    }
+    void rowPosition(DataPoint &dp,
+                     const GeographicLib::LocalCartesian *proj) const;
+    static void rowStep(DataPoint &dp, const DataPoint *dpPrev);
+    static void rowRawHeading(DataPoint &dp);
+    void rowHeading(DataPoint &dp, const DataPoint *dpPrev) const;
+    void rowAerodynamics(DataPoint &dp, const double *accel,
+                         double density) const;
+
+    // Position is projected rather than found from geodesics
+    bool projected() const { return !mExactGeodesic && mOrigin.hasGeodetic; }
+
+    bool sameProjection(const TrackProcessor &other) const;
+
+    // Wind used for derived values
+    double effectiveWindE() const { return mWindAdjustment ? mWindE : 0; }
+    double effectiveWindN() const { return mWindAdjustment ? mWindN : 0; }
+
+    bool      mWindAdjustment;
+    double    mWindE, mWindN;
+
+    double    mMass;
+    double    mPlanformArea;
+
+    double    mGroundReference;
+    qint64    mTimeReference;
+
+    bool      mExactGeodesic;
+    bool      mParallel;
+
+    DerivativeEngine mSlopes;
+
+    DataPoint mOrigin;
+
+    double    mOffsetT;
+    double    mOffsetX, mOffsetY, mOffsetZ;
+    double    mOffsetTheta;
+};
+
+Q_DECLARE_METATYPE(TrackProcessor)
+
+#endif // TRACKPROCESSOR_H
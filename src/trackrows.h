@@ -0,0 +1,31 @@
+#ifndef TRACKROWS_H
+#define TRACKROWS_H
+
+#include <QVector>
+
+#include "datapoint.h"
+#include "trackstore.h"
+
+// Rows of either a track or a vector of rows, such as an optimized result,
+// so code that handles both can read the track shown without copying it.
+// Rows are returned by value, with track offsets applied.
+
+class TrackRows
+{
+public:
+    TrackRows(const QVector< DataPoint > &rows): mRows(&rows), mTrack(0) {}
+    TrackRows(const TrackStore &track): mRows(0), mTrack(&track) {}
+
+    int size() const { return mRows ? mRows->size() : mTrack->size(); }
+
+    double t(int i) const { return mRows ? (*mRows)[i].t : mTrack->value(i, TrackStore::T); }
+    double z(int i) const { return mRows ? (*mRows)[i].z : mTrack->value(i, TrackStore::Z); }
+
+    DataPoint operator[](int i) const { return mRows ? (*mRows)[i] : mTrack->at(i); }
+
+private:
+    const QVector< DataPoint > *mRows;
+    const TrackStore           *mTrack;
+};
+
+#endif // TRACKROWS_H
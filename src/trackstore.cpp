@@ -0,0 +1,1198 @@
+#include "trackstore.h"
+
+#include <QAtomicInt>
+
+#include <limits>
+#include <math.h>
+
+#include <string.h>
+
+namespace
+{
+
+// Last revision given to any track
+QAtomicInt lastRevision(0);
+
+// Nearest step of a fixed point value, saturating outside the range
+template< typename Integer >
+Integer quantize(
+        double value,
+        double scale)
+{
+    const double limit = std::numeric_limits< Integer >::max();
+    return (Integer) qRound64(qBound(-limit, value * scale, limit));
+}
+
+}
+
+double DataPoint::*const TrackStore::members[NumSV] =
+{
+    &DataPoint::lat, &DataPoint::lon, &DataPoint::hMSL,
+    &DataPoint::velN, &DataPoint::velE, &DataPoint::velD,
+    &DataPoint::hAcc, &DataPoint::vAcc, &DataPoint::sAcc,
+    &DataPoint::heading, &DataPoint::cAcc,
+    &DataPoint::t, &DataPoint::x, &DataPoint::y, &DataPoint::z,
+    &DataPoint::dist2D, &DataPoint::dist3D,
+    &DataPoint::curv, &DataPoint::accel,
+    &DataPoint::lift, &DataPoint::drag,
+    &DataPoint::vx, &DataPoint::vy,
+    &DataPoint::theta, &DataPoint::omega
+};
+
+// Format, steps per unit and source of each column in compact storage. A
+// derived column with a scale is stored in fixed point when on its own.
+const TrackStore::Encoding TrackStore::encodings[NumColumns] =
+{
+    { Fixed, 1e7, 0 },          // Lat
+    { Fixed, 1e7, 0 },          // Lon
+    { Fixed, 1e3, 0 },          // HMSL
+    { Short, 1e2, 0 },          // VelN
+    { Short, 1e2, 0 },          // VelE
+    { Short, 1e2, 0 },          // VelD
+    { Half, 0, 0 },             // HAcc
+    { Half, 0, 0 },             // VAcc
+    { Half, 0, 0 },             // SAcc
+    { Single, 0, 0 },           // Heading
+    { Half, 0, 0 },             // CAcc
+    { Derived, 1e4, Timestamp },// T
+    { Single, 0, 0 },           // X
+    { Single, 0, 0 },           // Y
+    { Derived, 0, HMSL },       // Z
+    { Single, 0, 0 },           // Dist2D
+    { Single, 0, 0 },           // Dist3D
+    { Half, 0, 0 },             // Curv
+    { Half, 0, 0 },             // Accel
+    { Half, 0, 0 },             // Lift
+    { Half, 0, 0 },             // Drag
+    { Derived, 0, VelE },       // Vx
+    { Derived, 0, VelN },       // Vy
+    { Derived, 0, Heading },    // Theta
+    { Half, 0, 0 },             // Omega
+    { Byte, 0, 0 }              // NumSV
+};
+
+TrackStore::TrackStore():
+    mCompact(false),
+    mRevision(0),
+    mSize(0),
+    mEditsBase(0),
+    mBucketOrigin(0),
+    mBucketScale(0),
+    mBucketsValid(false)
+{
+    clearOffsets();
+    resetCompact();
+}
+
+TrackStore::TrackStore(
+        const QVector< DataPoint > &rows,
+        bool compact):
+    mCompact(compact),
+    mRevision(0),
+    mSize(0),
+    mEditsBase(0),
+    mBucketOrigin(0),
+    mBucketScale(0),
+    mBucketsValid(false)
+{
+    clearOffsets();
+    resetCompact();
+    append(rows);
+}
+
+void TrackStore::clear()
+{
+    resize(0);
+}
+
+void TrackStore::reserve(
+        int size)
+{
+    for (int c = 0; c < NumColumns; ++c)
+    {
+        if (!mCompact)
+        {
+            mColumns[c].reserve(size);
+            continue;
+        }
+
+        switch (encodings[c].format)
+        {
+        case Fixed:
+            mFixed[c].reserve(size);
+            break;
+        case Short:
+        case Half:
+            mShorts[c].reserve(size);
+            break;
+        case Single:
+            mSingles[c].reserve(size);
+            break;
+        case Byte:
+            mBytes[c].reserve(size);
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (mCompact && !mWideTimes) mTimeSteps.reserve(size);
+    else                         mTimestamps.reserve(size);
+}
+
+void TrackStore::setCompact(
+        bool compact)
+{
+    if (compact == mCompact) return;
+
+    const int n = size();
+
+    // One column at a time, so only one column is ever held twice. Sources
+    // are converted before the columns derived from them and after them
+    // going back.
+    if (compact)
+    {
+        mCompact = true;
+        resetCompact();
+
+        const QVector< qint64 > timestamps = mTimestamps;
+        clearTimes();
+
+        for (int i = 0; i < n; ++i)
+        {
+            encodeTimestamp(i, timestamps[i]);
+        }
+
+        for (int c = 0; c < NumColumns; ++c)
+        {
+            const Column column = (Column) c;
+            const double *values = mColumns[c].constData();
+
+            if (encodings[c].format == Derived)
+            {
+                link(column, values);
+            }
+            else
+            {
+                switch (encodings[c].format)
+                {
+                case Fixed:
+                    mFixed[c].resize(n);
+                    break;
+                case Short:
+                case Half:
+                    mShorts[c].resize(n);
+                    break;
+                case Single:
+                    mSingles[c].resize(n);
+                    break;
+                default:
+                    mBytes[c].resize(n);
+                    break;
+                }
+
+                for (int i = 0; i < n; ++i)
+                {
+                    encode(i, column, values[i]);
+                }
+            }
+
+            mColumns[c] = QVector< double >();
+        }
+    }
+    else
+    {
+        for (int c = NumColumns - 1; c >= 0; --c)
+        {
+            QVector< double > values(n);
+            for (int i = 0; i < n; ++i)
+            {
+                values[i] = decode(i, (Column) c);
+            }
+
+            mColumns[c] = values;
+            mFixed[c] = QVector< qint32 >();
+            mShorts[c] = QVector< qint16 >();
+            mSingles[c] = QVector< float >();
+            mBytes[c] = QVector< quint8 >();
+        }
+
+        QVector< qint64 > timestamps(n);
+        for (int i = 0; i < n; ++i)
+        {
+            timestamps[i] = timestamp(i);
+        }
+
+        mTimestamps = timestamps;
+        mTimeSteps = QVector< qint32 >();
+
+        mCompact = false;
+        resetCompact();
+    }
+
+    mBucketsValid = false;
+    touch();
+}
+
+int TrackStore::rowBytes() const
+{
+    // Bits of each column, then the geodetic flag
+    int bits = 1;
+
+    if (!mCompact)
+    {
+        return (bits + 8 * sizeof(qint64) * (NumColumns + 1) + 7) / 8;
+    }
+
+    for (int c = 0; c < NumColumns; ++c)
+    {
+        switch (encodings[c].format)
+        {
+        case Fixed:
+        case Single:
+            bits += 32;
+            break;
+        case Short:
+        case Half:
+            bits += 16;
+            break;
+        case Byte:
+            bits += 8;
+            break;
+        default:
+            if (mLinks[c] == Unlinked) bits += 32;
+            break;
+        }
+    }
+
+    bits += mWideTimes ? 64 : 32;
+
+    return (bits + 7) / 8;
+}
+
+void TrackStore::setOffset(
+        Column column,
+        double offset)
+{
+    mOffsets[column] = offset;
+}
+
+void TrackStore::clearOffsets()
+{
+    for (int c = 0; c < NumColumns; ++c)
+    {
+        mOffsets[c] = 0;
+    }
+}
+
+void TrackStore::touch(
+        int first)
+{
+    mRevision = (quint32) lastRevision.fetchAndAddRelaxed(1) + 1;
+
+    // Nothing is known of rows before a change to the whole track
+    if (first <= 0)
+    {
+        mEdits.clear();
+        mEditsBase = mRevision;
+        return;
+    }
+
+    if (mEdits.size() == MaxEdits)
+    {
+        mEditsBase = mEdits.first().revision;
+        mEdits.removeFirst();
+    }
+
+    Edit edit;
+    edit.revision = mRevision;
+    edit.first = first;
+    mEdits.append(edit);
+}
+
+int TrackStore::firstChanged(
+        quint32 revision) const
+{
+    if (revision == mRevision) return size();
+
+    // Back through the changes made since that revision
+    int first = size();
+    for (int i = mEdits.size() - 1; i >= 0; --i)
+    {
+        first = qMin(first, mEdits[i].first);
+
+        const quint32 before = (i > 0) ? mEdits[i - 1].revision : mEditsBase;
+        if (before == revision) return first;
+    }
+
+    return 0;
+}
+
+void TrackStore::append(
+        const QVector< DataPoint > &rows)
+{
+    setRows(size(), rows);
+}
+
+void TrackStore::setRows(
+        int begin,
+        const QVector< DataPoint > &rows)
+{
+    const int end = begin + rows.size();
+
+    // Rows skipped over are added as by resize, the rest are written below
+    if (begin > size()) resize(begin);
+
+    const bool whole = (begin == 0 && end >= size());
+    if (end > size()) resizeRows(end);
+
+    mBucketsValid = false;
+    touch(begin);
+
+    if (mCompact)
+    {
+        // Timestamps and sources first, so derived columns are checked
+        // against the new rows
+        if (whole) clearTimes();
+
+        for (int i = 0; i < rows.size(); ++i)
+        {
+            encodeTimestamp(begin + i, rows[i].timestamp);
+        }
+
+        QVector< double > values;
+
+        for (int c = 0; c < NumSV; ++c)
+        {
+            const Column column = (Column) c;
+            double DataPoint::*const member = members[c];
+
+            if (encodings[c].format == Derived)
+            {
+                values.resize(rows.size());
+                for (int i = 0; i < rows.size(); ++i)
+                {
+                    values[i] = rows[i].*member;
+                }
+
+                if (whole) link(column, values.constData());
+                else       writeDerived(begin, column, values);
+                continue;
+            }
+
+            for (int i = 0; i < rows.size(); ++i)
+            {
+                encode(begin + i, column, rows[i].*member);
+            }
+        }
+
+        for (int i = 0; i < rows.size(); ++i)
+        {
+            encode(begin + i, NumSV, rows[i].numSV);
+        }
+    }
+    else
+    {
+        // One column at a time, so each array is written in order
+        for (int c = 0; c < NumSV; ++c)
+        {
+            double *column = mColumns[c].data() + begin;
+            double DataPoint::*const member = members[c];
+
+            for (int i = 0; i < rows.size(); ++i)
+            {
+                column[i] = rows[i].*member;
+            }
+        }
+
+        for (int i = 0; i < rows.size(); ++i)
+        {
+            mColumns[NumSV][begin + i] = rows[i].numSV;
+            mTimestamps[begin + i] = rows[i].timestamp;
+        }
+    }
+
+    for (int i = 0; i < rows.size(); ++i)
+    {
+        mGeodetic.setBit(begin + i, rows[i].hasGeodetic);
+    }
+}
+
+void TrackStore::setColumn(
+        Column column,
+        const double *values)
+{
+    const int n = size();
+
+    if (column == T) mBucketsValid = false;
+    touch();
+
+    if (!mCompact)
+    {
+        memcpy(mColumns[column].data(), values, n * sizeof(double));
+    }
+    else if (encodings[column].format == Derived)
+    {
+        link(column, values);
+    }
+    else
+    {
+        unlinkDependents(column);
+
+        for (int i = 0; i < n; ++i)
+        {
+            encode(i, column, values[i]);
+        }
+    }
+}
+
+void TrackStore::setColumn(
+        Column column,
+        const qint32 *values)
+{
+    const int n = size();
+
+    touch();
+
+    if (column == HasGeodetic)
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            mGeodetic.setBit(i, values[i] != 0);
+        }
+    }
+    else if (mCompact)
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            encode(i, column, values[i]);
+        }
+    }
+    else
+    {
+        double *data = mColumns[column].data();
+        for (int i = 0; i < n; ++i)
+        {
+            data[i] = values[i];
+        }
+    }
+}
+
+void TrackStore::setTimestamps(
+        const qint64 *values)
+{
+    const int n = size();
+
+    mBucketsValid = false;
+    touch();
+
+    if (mCompact)
+    {
+        unlinkDependents(Timestamp);
+        clearTimes();
+
+        for (int i = 0; i < n; ++i)
+        {
+            encodeTimestamp(i, values[i]);
+        }
+    }
+    else
+    {
+        memcpy(mTimestamps.data(), values, n * sizeof(qint64));
+    }
+}
+
+void TrackStore::resetCompact()
+{
+    for (int c = 0; c < NumColumns; ++c)
+    {
+        mLinks[c] = Unset;
+        mConstants[c] = 0;
+        mPassEnds[c] = -1;
+    }
+
+    mTimeBase = 0;
+    mTimeBaseSet = false;
+    mWideTimes = false;
+}
+
+void TrackStore::clearTimes()
+{
+    // The next timestamp written becomes the base
+    mTimeBaseSet = false;
+    mWideTimes = false;
+
+    mTimestamps = QVector< qint64 >();
+    mTimeSteps.resize(size());
+}
+
+void TrackStore::encode(
+        int i,
+        Column column,
+        double value)
+{
+    const Encoding &encoding = encodings[column];
+
+    switch (encoding.format)
+    {
+    case Fixed:
+        mFixed[column][i] = quantize< qint32 >(value, encoding.scale);
+        break;
+    case Short:
+        mShorts[column][i] = quantize< qint16 >(value, encoding.scale);
+        break;
+    case Single:
+        mSingles[column][i] = (float) value;
+        break;
+    case Half:
+        mShorts[column][i] = toHalf(value);
+        break;
+    case Byte:
+        mBytes[column][i] = (quint8) qBound(0, qRound(value), 255);
+        break;
+    default:
+        // Nothing to store while the row fits the column's constant
+        if (mLinks[column] == Unset && value == 0) break;
+        if (mLinks[column] == Linked
+                && fits(i, column, value, mConstants[column]))
+        {
+            break;
+        }
+
+        unlink(column);
+        store(i, column, value);
+        break;
+    }
+}
+
+void TrackStore::encodeTimestamp(
+        int i,
+        qint64 timestamp)
+{
+    if (!mTimeBaseSet)
+    {
+        mTimeBase = timestamp;
+        mTimeBaseSet = true;
+    }
+
+    if (!mWideTimes)
+    {
+        const qint64 step = timestamp - mTimeBase;
+
+        if (step >= std::numeric_limits< qint32 >::min()
+                && step <= std::numeric_limits< qint32 >::max())
+        {
+            mTimeSteps[i] = (qint32) step;
+            return;
+        }
+
+        widenTimes();
+    }
+
+    mTimestamps[i] = timestamp;
+}
+
+void TrackStore::widenTimes()
+{
+    const int n = size();
+
+    QVector< qint64 > timestamps(n);
+    for (int i = 0; i < n; ++i)
+    {
+        timestamps[i] = mTimeBase + mTimeSteps[i];
+    }
+
+    mTimestamps = timestamps;
+    mTimeSteps = QVector< qint32 >();
+    mWideTimes = true;
+}
+
+void TrackStore::link(
+        Column column,
+        const double *values)
+{
+    const int n = size();
+    const bool linked = mLinks[column] == Linked;
+
+    mPassEnds[column] = -1;
+    mLinks[column] = (n > 0) ? Unlinked : Unset;
+    if (n == 0) return;
+
+    const double constant = values[0] - sourceValue(0, column);
+
+    if (linked && fits(column, values, mConstants[column]))
+    {
+        // Keep the constant in use, so values read back store unchanged
+    }
+    else if (fits(column, values, constant))
+    {
+        mConstants[column] = constant;
+    }
+    else
+    {
+        if (encodings[column].scale != 0) mFixed[column].resize(n);
+        else                              mSingles[column].resize(n);
+
+        for (int i = 0; i < n; ++i)
+        {
+            store(i, column, values[i]);
+        }
+
+        return;
+    }
+
+    mLinks[column] = Linked;
+    mFixed[column] = QVector< qint32 >();
+    mSingles[column] = QVector< float >();
+}
+
+bool TrackStore::fits(
+        Column column,
+        const double *values,
+        double constant) const
+{
+    for (int i = 0; i < size(); ++i)
+    {
+        if (!fits(i, column, values[i], constant)) return false;
+    }
+
+    return true;
+}
+
+bool TrackStore::fits(
+        int i,
+        Column column,
+        double value,
+        double constant) const
+{
+    const double source = sourceValue(i, column);
+    const double error = source + constant - value;
+
+    return qAbs(error) <= tolerance(column, value, source);
+}
+
+void TrackStore::writeDerived(
+        int begin,
+        Column column,
+        const QVector< double > &values)
+{
+    const int end = begin + values.size();
+
+    // A pass starts at the first row and goes on from where it stopped
+    if (begin == 0 && !values.isEmpty())
+    {
+        mPassConstants[column] = values[0] - sourceValue(0, column);
+        mPassFits[column] = true;
+    }
+    else if (begin != mPassEnds[column])
+    {
+        mPassEnds[column] = -1;
+    }
+
+    const bool pass = (begin == 0 || mPassEnds[column] >= 0);
+
+    for (int i = 0; i < values.size(); ++i)
+    {
+        encode(begin + i, column, values[i]);
+
+        if (pass && mPassFits[column])
+        {
+            mPassFits[column] = fits(begin + i, column, values[i], mPassConstants[column]);
+        }
+    }
+
+    mPassEnds[column] = pass ? end : -1;
+
+    if (pass && end == size() && mPassFits[column] && mLinks[column] == Unlinked)
+    {
+        mLinks[column] = Linked;
+        mConstants[column] = mPassConstants[column];
+        mFixed[column] = QVector< qint32 >();
+        mSingles[column] = QVector< float >();
+    }
+}
+
+void TrackStore::unlink(
+        Column column)
+{
+    if (mLinks[column] == Unlinked) return;
+
+    const int n = size();
+
+    QVector< double > values(n);
+    for (int i = 0; i < n; ++i)
+    {
+        values[i] = decodeDerived(i, column);
+    }
+
+    if (encodings[column].scale != 0) mFixed[column].resize(n);
+    else                              mSingles[column].resize(n);
+
+    mLinks[column] = Unlinked;
+
+    for (int i = 0; i < n; ++i)
+    {
+        store(i, column, values[i]);
+    }
+}
+
+void TrackStore::unlinkDependents(
+        Column source)
+{
+    for (int c = 0; c < NumColumns; ++c)
+    {
+        if (encodings[c].format != Derived) continue;
+        if (encodings[c].source != source) continue;
+
+        // Rows of a pass were checked against the old values
+        mPassEnds[c] = -1;
+        if (mLinks[c] == Linked) unlink((Column) c);
+    }
+}
+
+void TrackStore::store(
+        int i,
+        Column column,
+        double value)
+{
+    const double scale = encodings[column].scale;
+
+    if (scale != 0) mFixed[column][i] = quantize< qint32 >(value, scale);
+    else            mSingles[column][i] = (float) value;
+}
+
+double TrackStore::sourceValue(
+        int i,
+        Column column) const
+{
+    const int source = encodings[column].source;
+
+    if (source == Timestamp) return (timestamp(i) - mTimeBase) / 1000.;
+    return decode(i, (Column) source);
+}
+
+double TrackStore::tolerance(
+        Column column,
+        double value,
+        double source) const
+{
+    // Errors of the source at the row and at the first row, which the
+    // constant is found from, and rounding in the sum
+    const double rounding = 1e-12 * (qAbs(value) + qAbs(source));
+    const int s = encodings[column].source;
+
+    if (s == Timestamp) return 1e-6 + rounding;
+
+    switch (encodings[s].format)
+    {
+    case Fixed:
+    case Short:
+        return 1. / encodings[s].scale + rounding;
+    default:
+        return 6e-8 * (qAbs(source) + qAbs(sourceValue(0, column))) + rounding;
+    }
+}
+
+double TrackStore::decodeDerived(
+        int i,
+        Column column) const
+{
+    switch (mLinks[column])
+    {
+    case Linked:
+        return sourceValue(i, column) + mConstants[column];
+    case Unlinked:
+        if (encodings[column].scale != 0)
+        {
+            return mFixed[column][i] / encodings[column].scale;
+        }
+        return mSingles[column][i];
+    default:
+        return 0;
+    }
+}
+
+qint16 TrackStore::toHalf(
+        double value)
+{
+    // Sign, 5 bits of exponent biased by 15 and 10 bits of mantissa, rounded
+    // to nearest and saturating at the largest finite value
+    if (value != value) return (qint16) 0x7e00;
+
+    const quint16 sign = (value < 0) ? 0x8000 : 0;
+    const double a = qAbs(value);
+
+    quint16 bits;
+    if (!(a <= 65504))
+    {
+        bits = 0x7bff;
+    }
+    else
+    {
+        int e;
+        frexp(a, &e);
+
+        // Steps of the binade of a, or of subnormals
+        const int stepExp = qMax(e - 11, -24);
+        double steps = rint(ldexp(a, -stepExp));
+
+        if (steps < 1024)
+        {
+            bits = (quint16) steps;
+        }
+        else
+        {
+            int exponent = stepExp + 25;
+            if (steps == 2048)
+            {
+                steps = 1024;
+                ++exponent;
+            }
+
+            if (exponent > 30) bits = 0x7bff;
+            else bits = (quint16) ((exponent << 10) | ((int) steps - 1024));
+        }
+    }
+
+    return (qint16) (sign | bits);
+}
+
+double TrackStore::fromHalf(
+        qint16 bits)
+{
+    const quint16 b = (quint16) bits;
+    const int exponent = (b >> 10) & 0x1f;
+    const int mantissa = b & 0x3ff;
+
+    double value;
+    if (exponent == 0)
+    {
+        value = ldexp((double) mantissa, -24);
+    }
+    else if (exponent == 31)
+    {
+        value = mantissa ? std::numeric_limits< double >::quiet_NaN()
+                         : std::numeric_limits< double >::infinity();
+    }
+    else
+    {
+        value = ldexp((double) (mantissa | 0x400), exponent - 25);
+    }
+
+    return (b & 0x8000) ? -value : value;
+}
+
+QVector< DataPoint > TrackStore::rows(
+        int begin,
+        int end) const
+{
+    QVector< DataPoint > result = rawRows(begin, end);
+
+    for (int c = 0; c < NumSV; ++c)
+    {
+        const double offset = mOffsets[c];
+        if (offset == 0) continue;
+
+        double DataPoint::*const member = members[c];
+        for (int i = 0; i < result.size(); ++i)
+        {
+            result[i].*member -= offset;
+        }
+    }
+
+    return result;
+}
+
+QVector< DataPoint > TrackStore::rawRows(
+        int begin,
+        int end) const
+{
+    if (end < 0) end = size();
+
+    QVector< DataPoint > result(end - begin);
+
+    for (int c = 0; c < NumSV; ++c)
+    {
+        double DataPoint::*const member = members[c];
+
+        if (mCompact)
+        {
+            for (int i = 0; i < result.size(); ++i)
+            {
+                result[i].*member = decode(begin + i, (Column) c);
+            }
+        }
+        else
+        {
+            const double *column = mColumns[c].constData() + begin;
+
+            for (int i = 0; i < result.size(); ++i)
+            {
+                result[i].*member = column[i];
+            }
+        }
+    }
+
+    for (int i = 0; i < result.size(); ++i)
+    {
+        DataPoint &dp = result[i];
+
+        dp.numSV = (int) rawValue(begin + i, NumSV);
+        dp.timestamp = timestamp(begin + i);
+        dp.hasGeodetic = hasGeodetic(begin + i);
+    }
+
+    return result;
+}
+
+DataPoint TrackStore::at(
+        int i) const
+{
+    DataPoint dp;
+    read(i, AllColumns, dp);
+    return dp;
+}
+
+void TrackStore::read(
+        int i,
+        quint32 columns,
+        DataPoint &dp) const
+{
+    for (int c = 0; c < NumSV; ++c)
+    {
+        if (columns & (1u << c))
+        {
+            dp.*members[c] = value(i, (Column) c);
+        }
+    }
+
+    if (columns & mask(NumSV)) dp.numSV = (int) rawValue(i, NumSV);
+    if (columns & mask(Timestamp)) dp.timestamp = timestamp(i);
+    if (columns & mask(HasGeodetic)) dp.hasGeodetic = hasGeodetic(i);
+}
+
+void TrackStore::readRaw(
+        int i,
+        quint32 columns,
+        DataPoint &dp) const
+{
+    for (int c = 0; c < NumSV; ++c)
+    {
+        if (columns & (1u << c))
+        {
+            dp.*members[c] = rawValue(i, (Column) c);
+        }
+    }
+
+    if (columns & mask(NumSV)) dp.numSV = (int) rawValue(i, NumSV);
+    if (columns & mask(Timestamp)) dp.timestamp = timestamp(i);
+    if (columns & mask(HasGeodetic)) dp.hasGeodetic = hasGeodetic(i);
+}
+
+TrackStore::Span TrackStore::column(
+        Column column) const
+{
+    return Span(this, column);
+}
+
+int TrackStore::findIndexBelowT(
+        double t) const
+{
+    return lowerBoundT(t + mOffsets[T]) - 1;
+}
+
+int TrackStore::findIndexAboveT(
+        double t) const
+{
+    return upperBoundT(t + mOffsets[T]);
+}
+
+DataPoint TrackStore::interpolateT(
+        double t) const
+{
+    int i1, i2;
+    double fraction;
+
+    bracketT(t, i1, i2, fraction);
+
+    if (i1 < 0)
+    {
+        return at(0);
+    }
+    else if (i2 >= size())
+    {
+        return at(size() - 1);
+    }
+    else
+    {
+        return DataPoint::interpolate(at(i1), at(i2), fraction);
+    }
+}
+
+void TrackStore::bracketT(
+        double t,
+        int &below,
+        int &above,
+        double &fraction) const
+{
+    const double raw = t + mOffsets[T];
+    const int lower = lowerBoundT(raw);
+
+    below = lower - 1;
+
+    // Skip rows exactly at t
+    above = lower;
+    while (above < size() && rawValue(above, T) <= raw) ++above;
+
+    fraction = 0;
+    if (below >= 0 && above < size())
+    {
+        const double t1 = value(below, T);
+        const double t2 = value(above, T);
+        fraction = (t - t1) / (t2 - t1);
+    }
+}
+
+int TrackStore::lowerBoundT(
+        double t) const
+{
+    updateBuckets();
+
+    // Rows in earlier buckets are before t and rows in later ones after it
+    const int b = bucket(t);
+
+    int below = mBuckets[b] - 1;
+    int above = mBuckets[b + 1];
+
+    while (below + 1 != above)
+    {
+        int mid = (below + above) / 2;
+
+        if (rawValue(mid, T) < t) below = mid;
+        else                      above = mid;
+    }
+
+    return above;
+}
+
+int TrackStore::upperBoundT(
+        double t) const
+{
+    int i = lowerBoundT(t);
+    while (i < size() && rawValue(i, T) <= t) ++i;
+    return i;
+}
+
+void TrackStore::updateBuckets() const
+{
+    if (mBucketsValid) return;
+
+    const int n = size();
+    const int count = qMax(1, n / RowsPerBucket);
+
+    mBuckets.resize(count + 1);
+
+    mBucketOrigin = (n > 0) ? rawValue(0, T) : 0;
+    const double length = (n > 0) ? rawValue(n - 1, T) - mBucketOrigin : 0;
+    mBucketScale = (length > 0) ? count / length : 0;
+
+    // Rows are in order of t, so each bucket starts where the last one ends
+    int b = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        const int last = bucket(rawValue(i, T));
+        while (b <= last) mBuckets[b++] = i;
+    }
+
+    while (b <= count) mBuckets[b++] = n;
+
+    mBucketsValid = true;
+}
+
+int TrackStore::bucket(
+        double t) const
+{
+    // Same arithmetic for rows and searches, so both agree on boundaries
+    const double pos = (t - mBucketOrigin) * mBucketScale;
+    const int last = mBuckets.size() - 2;
+
+    if (!(pos > 0))  return 0;
+    if (pos >= last) return last;
+    return (int) pos;
+}
+
+void TrackStore::resize(
+        int size)
+{
+    const int n = this->size();
+
+    mBucketsValid = false;
+    touch(qMin(size, n));
+
+    // New rows read as zero. Linked columns can't hold those.
+    if (mCompact)
+    {
+        for (int c = 0; c < NumColumns; ++c)
+        {
+            mPassEnds[c] = -1;
+
+            if (size > n && encodings[c].format == Derived && mLinks[c] == Linked)
+            {
+                unlink((Column) c);
+            }
+        }
+    }
+
+    resizeRows(size);
+
+    if (mCompact)
+    {
+        for (int i = n; i < size; ++i)
+        {
+            encodeTimestamp(i, 0);
+        }
+
+        if (size == 0) resetCompact();
+    }
+}
+
+void TrackStore::resizeRows(
+        int size)
+{
+    for (int c = 0; c < NumColumns; ++c)
+    {
+        if (!mCompact)
+        {
+            mColumns[c].resize(size);
+            continue;
+        }
+
+        switch (encodings[c].format)
+        {
+        case Fixed:
+            mFixed[c].resize(size);
+            break;
+        case Short:
+        case Half:
+            mShorts[c].resize(size);
+            break;
+        case Single:
+            mSingles[c].resize(size);
+            break;
+        case Byte:
+            mBytes[c].resize(size);
+            break;
+        default:
+            if (mLinks[c] != Unlinked) break;
+            if (encodings[c].scale != 0) mFixed[c].resize(size);
+            else                         mSingles[c].resize(size);
+            break;
+        }
+    }
+
+    if (mCompact && !mWideTimes) mTimeSteps.resize(size);
+    else                         mTimestamps.resize(size);
+
+    mGeodetic.resize(size);
+    mSize = size;
+}
@@ -0,0 +1,344 @@
+#ifndef TRACKSTORE_H
+#define TRACKSTORE_H
+
+#include <QBitArray>
+#include <QMetaType>
+#include <QVector>
+
+#include "datapoint.h"
+
+// Track stored as one contiguous array per value rather than one record per
+// row, so a loop over one or two values only reads those arrays. An offset
+// can be set for each column; it is subtracted whenever the column is read,
+// which moves the zero of a column without rewriting it. Rows can still be
+// read and written as DataPoints while code migrates to columns.
+//
+// Compact storage cuts a row from 217 bytes to 62. Values are decoded
+// whenever they are read, within these errors:
+//   Lat, Lon        fixed point in 1e-7 degrees and 1 mm, the resolution of
+//   HMSL            the receiver, so its values are read back exactly
+//   VelN, VelE,     fixed point in 1 cm/s, so within 5 mm/s, saturating at
+//   VelD            +/- 327 m/s
+//   HAcc, VAcc,     half precision, a relative error of at most 4.9e-4 down
+//   SAcc, CAcc,     to 6.1e-5 and 3e-8 below it, saturating at 65504
+//   Curv, Accel,
+//   Lift, Drag,
+//   Omega
+//   T, Z, Vx, Vy,   the timestamp, HMSL, VelE, VelN and Heading plus a
+//   Theta           constant for the track, within 1 us for T and the error
+//                   of the source at the row plus that at the first row for
+//                   the others
+//   others          single precision, a relative error of at most 6e-8 (0.6 mm
+//                   at 10 km); numSV is exact up to 255
+// Timestamps are exact, stored as milliseconds from the first one while they
+// are within 24 days of it. A derived column with a row that doesn't fit its
+// constant is stored on its own, T in fixed point in 0.1 ms and the others in
+// single precision, until every row has been written again in order from the
+// first. Writing values that were read back stores them unchanged, so tracks
+// can be processed again without the errors growing.
+//
+// Every encoding reads and writes single rows in place, as spans, searches
+// on t and setRows need; none is relative to the row before.
+//
+// Columns are implicitly shared, so copies of a track are cheap until one
+// of them is changed.
+
+class TrackStore
+{
+public:
+    typedef enum {
+        Lat = 0, Lon, HMSL,
+        VelN, VelE, VelD,
+        HAcc, VAcc, SAcc,
+        Heading, CAcc,
+        T, X, Y, Z,
+        Dist2D, Dist3D,
+        Curv, Accel,
+        Lift, Drag,
+        Vx, Vy,
+        Theta, Omega,
+        NumSV,
+        Timestamp, HasGeodetic,
+        colLast
+    } Column;
+
+    enum { AllColumns = (1 << colLast) - 1 };
+
+    static quint32 mask(Column column) { return 1u << column; }
+
+    // Values of one column, with its offset applied
+    class Span
+    {
+    public:
+        Span(): mStore(0), mColumn(T), mData(0), mSize(0), mOffset(0) {}
+        Span(const TrackStore *store, Column column):
+            mStore(store), mColumn(column),
+            mData(store->mCompact ? 0 : store->mColumns[column].constData()),
+            mSize(store->size()), mOffset(store->mOffsets[column]) {}
+
+        int size() const { return mSize; }
+        bool isEmpty() const { return mSize == 0; }
+
+        double operator[](int i) const
+        {
+            if (mData) return mData[i] - mOffset;
+            return mStore->decode(i, mColumn) - mOffset;
+        }
+        double first() const { return (*this)[0]; }
+        double last() const { return (*this)[mSize - 1]; }
+
+        // Stored values and the offset to subtract from them. There are no
+        // stored doubles in compact storage.
+        const double *data() const { return mData; }
+        double offset() const { return mOffset; }
+
+    private:
+        const TrackStore *mStore;
+        Column            mColumn;
+        const double     *mData;
+        int               mSize;
+        double            mOffset;
+    };
+
+    // One row, read column by column on demand
+    class Row
+    {
+    public:
+        Row(const TrackStore *store, int i): mStore(store), mIndex(i) {}
+
+        int index() const { return mIndex; }
+        double operator[](Column column) const { return mStore->value(mIndex, column); }
+        qint64 timestamp() const { return mStore->timestamp(mIndex); }
+
+        operator DataPoint() const { return mStore->at(mIndex); }
+
+    private:
+        const TrackStore *mStore;
+        int               mIndex;
+    };
+
+    TrackStore();
+    explicit TrackStore(const QVector< DataPoint > &rows, bool compact = false);
+
+    int size() const { return mSize; }
+    bool isEmpty() const { return mSize == 0; }
+
+    void clear();
+    void reserve(int size);
+    void resize(int size);
+
+    // Converts the rows already stored
+    void setCompact(bool compact);
+    bool isCompact() const { return mCompact; }
+
+    // Bytes used by the values of each row, rounded up
+    int rowBytes() const;
+
+    void append(const QVector< DataPoint > &rows);
+
+    // Overwrites rows from begin onwards, growing the track as needed
+    void setRows(int begin, const QVector< DataPoint > &rows);
+
+    // Replaces the stored values of every row of one column. Numbers of
+    // satellites and the geodetic flag are set from integers and timestamps
+    // from their own type.
+    void setColumn(Column column, const double *values);
+    void setColumn(Column column, const qint32 *values);
+    void setTimestamps(const qint64 *values);
+
+    // Rows [begin, end) with offsets applied, or as stored
+    QVector< DataPoint > rows(int begin = 0, int end = -1) const;
+    QVector< DataPoint > rawRows(int begin = 0, int end = -1) const;
+
+    DataPoint at(int i) const;
+    Row row(int i) const { return Row(this, i); }
+
+    // Reads only the columns in the mask into dp, with offsets applied or
+    // as stored
+    void read(int i, quint32 columns, DataPoint &dp) const;
+    void readRaw(int i, quint32 columns, DataPoint &dp) const;
+
+    Span column(Column column) const;
+
+    double value(int i, Column column) const
+    {
+        return rawValue(i, column) - mOffsets[column];
+    }
+    double rawValue(int i, Column column) const
+    {
+        if (mCompact) return decode(i, column);
+        return mColumns[column][i];
+    }
+    qint64 timestamp(int i) const
+    {
+        if (mCompact && !mWideTimes) return mTimeBase + mTimeSteps[i];
+        return mTimestamps[i];
+    }
+    bool hasGeodetic(int i) const { return mGeodetic.testBit(i); }
+
+    void setOffset(Column column, double offset);
+    double offset(Column column) const { return mOffsets[column]; }
+    void clearOffsets();
+
+    // Changes whenever a stored value does, and differs between tracks, so
+    // it can key values computed from the track. Offsets leave it alone;
+    // they move every value of a column alike.
+    quint32 revision() const { return mRevision; }
+
+    // First row that may differ from the track at an earlier revision, or
+    // 0 if that revision is not among the last few changes to rows
+    int firstChanged(quint32 revision) const;
+
+    // Searches on t, with its offset applied. Times are looked up in a table
+    // of buckets over the track, so evenly sampled tracks need only a probe
+    // or two.
+    int findIndexBelowT(double t) const;
+    int findIndexAboveT(double t) const;
+    DataPoint interpolateT(double t) const;
+
+    // Last row before t, first row after it and the fraction of the way
+    // from one to the other at t, from a single search. The fraction is
+    // only valid when both rows are within the track.
+    void bracketT(double t, int &below, int &above, double &fraction) const;
+
+private:
+    enum { NumColumns = Timestamp };
+
+    // How each column is kept in compact storage
+    typedef enum {
+        Fixed,          // 32-bit fixed point
+        Short,          // 16-bit fixed point
+        Single,         // single precision
+        Half,           // half precision
+        Byte,           // 8-bit unsigned integer
+        Derived         // another column plus a constant
+    } Format;
+
+    typedef struct {
+        Format format;
+        double scale;   // Steps per unit of fixed point, also when derived
+        int    source;  // Column a derived column is computed from
+    } Encoding;
+
+    // Derived columns have no constant until a row is written, and are
+    // stored on their own once a row doesn't fit it
+    typedef enum {
+        Unset, Linked, Unlinked
+    } Link;
+
+    bool              mCompact;
+    quint32           mRevision;
+    int               mSize;
+
+    QVector< double > mColumns[NumColumns];
+    double            mOffsets[NumColumns];
+
+    // Compact columns, in the array their format uses. Half precision is
+    // kept as its bits.
+    QVector< qint32 > mFixed[NumColumns];
+    QVector< qint16 > mShorts[NumColumns];
+    QVector< float >  mSingles[NumColumns];
+    QVector< quint8 > mBytes[NumColumns];
+
+    Link              mLinks[NumColumns];
+    double            mConstants[NumColumns];
+
+    // Rows of derived columns written in order from the first, and whether
+    // they fit one constant, so a column stored on its own is linked again
+    // once its last row is written
+    int               mPassEnds[NumColumns];
+    double            mPassConstants[NumColumns];
+    bool              mPassFits[NumColumns];
+
+    // Compact timestamps are steps from the first one while they fit
+    QVector< qint64 > mTimestamps;
+    QVector< qint32 > mTimeSteps;
+    qint64            mTimeBase;
+    bool              mTimeBaseSet;
+    bool              mWideTimes;
+
+    QBitArray         mGeodetic;
+
+    // First row in each bucket of t, built when first needed
+    enum { RowsPerBucket = 4 };
+
+    mutable QVector< int > mBuckets;
+    mutable double         mBucketOrigin;
+    mutable double         mBucketScale;
+    mutable bool           mBucketsValid;
+
+    // Last changes to rows, each with its revision and first row changed,
+    // and the revision before the oldest of them
+    struct Edit
+    {
+        quint32 revision;
+        int     first;
+    };
+
+    enum { MaxEdits = 16 };
+
+    quint32           mEditsBase;
+    QVector< Edit >   mEdits;
+
+    static double DataPoint::*const members[NumSV];
+    static const Encoding encodings[NumColumns];
+
+    // New revision for rows changed from first onwards
+    void touch(int first = 0);
+
+    // First row with stored t not less than / greater than t
+    int lowerBoundT(double t) const;
+    int upperBoundT(double t) const;
+
+    void updateBuckets() const;
+    int bucket(double t) const;
+
+    // Sizes the arrays of each column, leaving values to be written
+    void resizeRows(int size);
+
+    // Compact storage
+    void resetCompact();
+    void clearTimes();
+    void encode(int i, Column column, double value);
+    void encodeTimestamp(int i, qint64 timestamp);
+    void widenTimes();
+
+    // Derived columns. Linking checks every row against one constant,
+    // the one in use first, and stores the column on its own if none fits.
+    void link(Column column, const double *values);
+    bool fits(Column column, const double *values, double constant) const;
+    bool fits(int i, Column column, double value, double constant) const;
+    void writeDerived(int begin, Column column, const QVector< double > &values);
+    void unlink(Column column);
+    void unlinkDependents(Column source);
+    void store(int i, Column column, double value);
+    double sourceValue(int i, Column column) const;
+    double tolerance(Column column, double value, double source) const;
+    double decodeDerived(int i, Column column) const;
+
+    double decode(int i, Column column) const
+    {
+        switch (encodings[column].format)
+        {
+        case Fixed:
+            return mFixed[column][i] / encodings[column].scale;
+        case Short:
+            return mShorts[column][i] / encodings[column].scale;
+        case Single:
+            return mSingles[column][i];
+        case Half:
+            return fromHalf(mShorts[column][i]);
+        case Byte:
+            return mBytes[column][i];
+        default:
+            return decodeDerived(i, column);
+        }
+    }
+
+    static qint16 toHalf(double value);
+    static double fromHalf(qint16 bits);
+};
+
+Q_DECLARE_METATYPE(TrackStore)
+
+#endif // TRACKSTORE_H
@@ -0,0 +1,62 @@
+#include <QFileInfo>
+
+#include "mainwindow.h"
+#include "trackcatalog.h"
+#include "trackview.h"
+
+TrackView::TrackView(QWidget *parent) :
+    QListWidget(parent),
+    mMainWindow(0)
+{
+    connect(this, SIGNAL(currentItemChanged(QListWidgetItem*,QListWidgetItem*)),
+            this, SLOT(selectTrack(QListWidgetItem*)));
+}
+
+QSize TrackView::sizeHint() const
+{
+    // Keeps windows from being intialized as very short
+    return QSize(175, 175);
+}
+
+void TrackView::updateView()
+{
+    const TrackCatalog *catalog = mMainWindow->trackCatalog();
+
+    // Don't switch tracks while rebuilding the list
+    blockSignals(true);
+    clear();
+
+    foreach (const QString &fileName, catalog->fileNames())
+    {
+        QListWidgetItem *item = new QListWidgetItem(QFileInfo(fileName).fileName());
+        item->setData(Qt::UserRole, fileName);
+        item->setToolTip(fileName);
+
+        if (catalog->isLoading(fileName))
+        {
+            item->setText(tr("%1 (loading)").arg(item->text()));
+        }
+
+        addItem(item);
+
+        if (fileName == mMainWindow->trackName())
+        {
+            QFont font = item->font();
+            font.setBold(true);
+            item->setFont(font);
+
+            setCurrentItem(item);
+        }
+    }
+
+    blockSignals(false);
+}
+
+void TrackView::selectTrack(
+        QListWidgetItem *current)
+{
+    if (current)
+    {
+        mMainWindow->selectTrack(current->data(Qt::UserRole).toString());
+    }
+}
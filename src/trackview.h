@@ -0,0 +1,29 @@
+#ifndef TRACKVIEW_H
+#define TRACKVIEW_H
+
+#include <QListWidget>
+
+class MainWindow;
+
+class TrackView : public QListWidget
+{
+    Q_OBJECT
+
+public:
+    explicit TrackView(QWidget *parent = 0);
+
+    virtual QSize sizeHint() const;
+
+    void setMainWindow(MainWindow *mainWindow) { mMainWindow = mainWindow; }
+
+private:
+    MainWindow *mMainWindow;
+
+public slots:
+    void updateView();
+
+private slots:
+    void selectTrack(QListWidgetItem *current);
+};
+
+#endif // TRACKVIEW_H
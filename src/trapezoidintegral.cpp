@@ -0,0 +1,50 @@
+#include "trapezoidintegral.h"
+
+#include <QtNumeric>
+
+#include <math.h>
+
+TrapezoidIntegral::TrapezoidIntegral()
+{
+
+}
+
+void TrapezoidIntegral::clear()
+{
+    mSums.clear();
+    mLengths.clear();
+}
+
+void TrapezoidIntegral::setValues(
+        const QVector< double > &t,
+        const QVector< double > &y,
+        int first)
+{
+    const int size = qMin(t.size(), y.size());
+
+    first = qBound(1, first, qMin(mSums.size(), size));
+
+    mSums.resize(size);
+    mLengths.resize(size);
+
+    if (size == 0) return;
+
+    mSums[0] = mLengths[0] = 0;
+
+    double sum = mSums[first - 1], length = mLengths[first - 1];
+
+    for (int i = first; i < size; ++i)
+    {
+        const double dt = fabs(t[i] - t[i - 1]);
+        const double avg = (y[i] + y[i - 1]) / 2;
+
+        if (!qIsNaN(avg) && !qIsNaN(dt))
+        {
+            sum += avg * dt;
+            length += dt;
+        }
+
+        mSums[i] = sum;
+        mLengths[i] = length;
+    }
+}
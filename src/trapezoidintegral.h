@@ -0,0 +1,31 @@
+#ifndef TRAPEZOIDINTEGRAL_H
+#define TRAPEZOIDINTEGRAL_H
+
+#include <QVector>
+
+// Integral of a series over time as running sums of the trapezoids between
+// consecutive rows, so the integral over any range of rows is the
+// difference of two sums. Trapezoids with a NaN at either end are left out
+// of both the integral and the time it covers.
+
+class TrapezoidIntegral
+{
+public:
+    TrapezoidIntegral();
+
+    // Sums from row first onwards, keeping those of earlier rows
+    void setValues(const QVector< double > &t, const QVector< double > &y, int first = 0);
+    void clear();
+
+    bool isEmpty() const { return mSums.isEmpty(); }
+
+    // Integral from row begin to row end, and the time it covers
+    double integral(int begin, int end) const { return mSums[end] - mSums[begin]; }
+    double length(int begin, int end) const { return mLengths[end] - mLengths[begin]; }
+
+private:
+    QVector< double > mSums;
+    QVector< double > mLengths;
+};
+
+#endif // TRAPEZOIDINTEGRAL_H
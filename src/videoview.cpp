@@ -166,7 +166,7 @@ void VideoView::updateView()
     if (!mBusy && mMainWindow->markActive())
     {
         // Get marked point
-        const DataPoint &dpEnd = mMainWindow->interpolateDataT(mMainWindow->markEnd());
+        const DataPoint dpEnd = mMainWindow->markPoint();
 
         // Get playback position
         int position = dpEnd.t * 1000 + mZeroPosition;
@@ -89,7 +89,7 @@ void WideOpenDistanceForm::updateView()
 
     // Find where we cross the bottom
     DataPoint dpBottom;
-    bool success = method->getWindowBounds(mMainWindow->data(), dpBottom);
+    bool success = method->getWindowBounds(mMainWindow->track(), dpBottom);
 
     if (mMainWindow->dataSize() == 0)
     {
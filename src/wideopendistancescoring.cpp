@@ -108,7 +108,7 @@ void WideOpenDistanceScoring::prepareDataPlot(
         DataPlot *plot)
 {
     DataPoint dpBottom;
-    bool success = getWindowBounds(mMainWindow->data(), dpBottom);
+    bool success = getWindowBounds(mMainWindow->track(), dpBottom);
 
     // Add shading for scoring window
     if (success && plot->yValue(DataPlot::Elevation)->visible())
@@ -226,7 +226,7 @@ void WideOpenDistanceScoring::prepareMapView(
 
     // Find where we cross the bottom
     DataPoint dpBottom;
-    bool success = getWindowBounds(mMainWindow->data(), dpBottom);
+    bool success = getWindowBounds(mMainWindow->track(), dpBottom);
 
     if (mMainWindow->dataSize() == 0)
     {
@@ -469,7 +469,7 @@ void WideOpenDistanceScoring::splitLine(
 }
 
 bool WideOpenDistanceScoring::getWindowBounds(
-        const QVector< DataPoint > &result,
+        const TrackRows &result,
         DataPoint &dpBottom)
 {
     bool foundBottom = false;
@@ -477,22 +477,22 @@ bool WideOpenDistanceScoring::getWindowBounds(
 
     for (int i = result.size() - 1; i >= 0; --i)
     {
-        const DataPoint &dp = result[i];
+        const double z = result.z(i);
 
-        if (dp.z < mBottom)
+        if (z < mBottom)
         {
             bottom = i;
             foundBottom = true;
         }
 
-        if (dp.t < 0) break;
+        if (result.t(i) < 0) break;
     }
 
     if (foundBottom)
     {
         // Calculate bottom of window
-        const DataPoint &dp1 = result[bottom - 1];
-        const DataPoint &dp2 = result[bottom];
+        const DataPoint dp1 = result[bottom - 1];
+        const DataPoint dp2 = result[bottom];
         dpBottom = DataPoint::interpolate(dp1, dp2, (mBottom - dp1.z) / (dp2.z - dp1.z));
 
         return true;
@@ -88,7 +88,7 @@ void WideOpenSpeedForm::updateView()
 
     // Find where we cross the bottom
     DataPoint dpBottom;
-    bool success = method->getWindowBounds(mMainWindow->data(), dpBottom);
+    bool success = method->getWindowBounds(mMainWindow->track(), dpBottom);
 
     if (mMainWindow->dataSize() == 0)
     {
@@ -109,16 +109,20 @@ void WideOpenSpeedForm::updateView()
     {
         // Calculate time
         int i, start = mMainWindow->findIndexBelowT(0) + 1;
-        double d1, t;
-        DataPoint dp1;
+        double d1, t, t1;
+
+        const TrackStore &track = mMainWindow->track();
+        const TrackStore::Span spanT = track.column(TrackStore::T);
+        const TrackStore::Span spanLat = track.column(TrackStore::Lat);
+        const TrackStore::Span spanLon = track.column(TrackStore::Lon);
 
         for (i = start; i < mMainWindow->dataSize(); ++i)
         {
-            const DataPoint &dp2 = mMainWindow->dataPoint(i);
+            const double t2 = spanT[i];
 
             // Get projected point
             double lat0, lon0;
-            intercept(dpTop.lat, dpTop.lon, endLatitude, endLongitude, dp2.lat, dp2.lon, lat0, lon0);
+            intercept(dpTop.lat, dpTop.lon, endLatitude, endLongitude, spanLat[i], spanLon[i], lat0, lon0);
 
             // Distance from top
             double topDist;
@@ -140,12 +144,12 @@ void WideOpenSpeedForm::updateView()
 
             if (i > start && d1 < laneLength && d2 >= laneLength)
             {
-                t = dp1.t + (dp2.t - dp1.t) / (d2 - d1) * (laneLength - d1);
+                t = t1 + (t2 - t1) / (d2 - d1) * (laneLength - d1);
                 break;
             }
 
             d1 = d2;
-            dp1 = dp2;
+            t1 = t2;
         }
 
         if (i < mMainWindow->dataSize())
@@ -154,7 +158,7 @@ void WideOpenSpeedForm::updateView()
 
             if (dp.t <= dpBottom.t)
             {
-                ui->speedEdit->setText(dp.dateTime.toString("hh:mm:ss.zzz"));
+                ui->speedEdit->setText(DataPoint::dateTime(dp).toString("hh:mm:ss.zzz"));
             }
             else
             {
@@ -108,7 +108,7 @@ void WideOpenSpeedScoring::prepareDataPlot(
         DataPlot *plot)
 {
     DataPoint dpBottom;
-    bool success = getWindowBounds(mMainWindow->data(), dpBottom);
+    bool success = getWindowBounds(mMainWindow->track(), dpBottom);
 
     // Add shading for scoring window
     if (success && plot->yValue(DataPlot::Elevation)->visible())
@@ -227,22 +227,26 @@ void WideOpenSpeedScoring::prepareMapView(
 
     // Find where we cross the bottom
     DataPoint dpBottom;
-    success = success && getWindowBounds(mMainWindow->data(), dpBottom);
+    success = success && getWindowBounds(mMainWindow->track(), dpBottom);
 
     if (success)
     {
         // Calculate time
         int i, start = mMainWindow->findIndexBelowT(0) + 1;
-        double d1, t;
-        DataPoint dp1;
+        double d1, t, t1;
+
+        const TrackStore &track = mMainWindow->track();
+        const TrackStore::Span spanT = track.column(TrackStore::T);
+        const TrackStore::Span spanLat = track.column(TrackStore::Lat);
+        const TrackStore::Span spanLon = track.column(TrackStore::Lon);
 
         for (i = start; i < mMainWindow->dataSize(); ++i)
         {
-            const DataPoint &dp2 = mMainWindow->dataPoint(i);
+            const double t2 = spanT[i];
 
             // Get projected point
             double lat0, lon0;
-            intercept(woProjLat, woProjLon, mEndLatitude, mEndLongitude, dp2.lat, dp2.lon, lat0, lon0);
+            intercept(woProjLat, woProjLon, mEndLatitude, mEndLongitude, spanLat[i], spanLon[i], lat0, lon0);
 
             // Distance from top
             double topDist;
@@ -264,12 +268,12 @@ void WideOpenSpeedScoring::prepareMapView(
 
             if (i > start && d1 < mLaneLength && d2 >= mLaneLength)
             {
-                t = dp1.t + (dp2.t - dp1.t) / (d2 - d1) * (mLaneLength - d1);
+                t = t1 + (t2 - t1) / (d2 - d1) * (mLaneLength - d1);
                 break;
             }
 
             d1 = d2;
-            dp1 = dp2;
+            t1 = t2;
         }
 
         if (i < mMainWindow->dataSize())
@@ -415,7 +419,7 @@ void WideOpenSpeedScoring::splitLine(
 }
 
 bool WideOpenSpeedScoring::getWindowBounds(
-        const QVector< DataPoint > &result,
+        const TrackRows &result,
         DataPoint &dpBottom)
 {
     bool foundBottom = false;
@@ -423,22 +427,22 @@ bool WideOpenSpeedScoring::getWindowBounds(
 
     for (int i = result.size() - 1; i >= 0; --i)
     {
-        const DataPoint &dp = result[i];
+        const double z = result.z(i);
 
-        if (dp.z < mBottom)
+        if (z < mBottom)
         {
             bottom = i;
             foundBottom = true;
         }
 
-        if (dp.t < 0) break;
+        if (result.t(i) < 0) break;
     }
 
     if (foundBottom)
     {
         // Calculate bottom of window
-        const DataPoint &dp1 = result[bottom - 1];
-        const DataPoint &dp2 = result[bottom];
+        const DataPoint dp1 = result[bottom - 1];
+        const DataPoint dp2 = result[bottom];
         dpBottom = DataPoint::interpolate(dp1, dp2, (mBottom - dp1.z) / (dp2.z - dp1.z));
 
         return true;
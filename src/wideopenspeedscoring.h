@@ -2,6 +2,7 @@
 #define WIDEOPENSPEEDSCORING_H
 
 #include "scoringmethod.h"
+#include "trackrows.h"
 
 class MainWindow;
 
@@ -38,7 +39,7 @@ public:
     bool updateReference(double lat, double lon);
     void closeReference();
 
-    bool getWindowBounds(const QVector< DataPoint > &result,
+    bool getWindowBounds(const TrackRows &result,
                          DataPoint &dpBottom);
 
     void readSettings();
@@ -85,23 +85,20 @@ void WindPlot::updatePlot()
     int start = mMainWindow->findIndexBelowT(lower) + 1;
     int end   = mMainWindow->findIndexAboveT(upper);
 
+    const TrackStore &track = mMainWindow->track();
+    const TrackStore::Span spanT = track.column(TrackStore::T);
+    const TrackStore::Span spanVelE = track.column(TrackStore::VelE);
+    const TrackStore::Span spanVelN = track.column(TrackStore::VelN);
+
+    const double factor = PlotValue::speedFactor(mMainWindow->units());
+
     bool first = true;
     for (int i = start; i < end; ++i)
     {
-        const DataPoint &dp = mMainWindow->dataPoint(i);
+        t.append(spanT[i]);
 
-        t.append(dp.t);
-
-        if (mMainWindow->units() == PlotValue::Metric)
-        {
-            x.append(dp.velE * MPS_TO_KMH);
-            y.append(dp.velN * MPS_TO_KMH);
-        }
-        else
-        {
-            x.append(dp.velE * MPS_TO_MPH);
-            y.append(dp.velN * MPS_TO_MPH);
-        }
+        x.append(spanVelE[i] * factor);
+        y.append(spanVelN[i] * factor);
 
         if (first)
         {
@@ -127,48 +124,12 @@ void WindPlot::updatePlot()
 
     setViewRange(xMin, xMax, yMin, yMax);
 
-    if (mMainWindow->markActive())
-    {
-        const DataPoint &dpEnd = mMainWindow->interpolateDataT(mMainWindow->markEnd());
-
-        t.clear();
-        x.clear();
-        y.clear();
-
-        QVector< double > xMark, yMark;
-
-        if (mMainWindow->units() == PlotValue::Metric)
-        {
-            xMark.append(dpEnd.velE * MPS_TO_KMH);
-            yMark.append(dpEnd.velN * MPS_TO_KMH);
-        }
-        else
-        {
-            xMark.append(dpEnd.velE * MPS_TO_MPH);
-            yMark.append(dpEnd.velN * MPS_TO_MPH);
-        }
-
-        QCPGraph *graph = addGraph();
-        graph->setData(xMark, yMark);
-        graph->setPen(QPen(Qt::black, mMainWindow->lineThickness()));
-        graph->setLineStyle(QCPGraph::lsNone);
-        graph->setScatterStyle(QCPScatterStyle::ssDisc);
-    }
-
     updateWind(start, end);
 
     QVector< double > xMark, yMark;
 
-    if (mMainWindow->units() == PlotValue::Metric)
-    {
-        xMark.append(mWindE * MPS_TO_KMH);
-        yMark.append(mWindN * MPS_TO_KMH);
-    }
-    else
-    {
-        xMark.append(mWindE * MPS_TO_MPH);
-        yMark.append(mWindN * MPS_TO_MPH);
-    }
+    xMark.append(mWindE * factor);
+    yMark.append(mWindN * factor);
 
     QCPGraph *graph = addGraph();
     graph->setData(xMark, yMark);
@@ -189,16 +150,8 @@ void WindPlot::updatePlot()
         const double x = x0 + r * cos((double) i / 100 * 2 * M_PI);
         const double y = y0 + r * sin((double) i / 100 * 2 * M_PI);
 
-        if (mMainWindow->units() == PlotValue::Metric)
-        {
-            xCircle.append(x * MPS_TO_KMH);
-            yCircle.append(y * MPS_TO_KMH);
-        }
-        else
-        {
-            xCircle.append(x * MPS_TO_MPH);
-            yCircle.append(y * MPS_TO_MPH);
-        }
+        xCircle.append(x * factor);
+        yCircle.append(y * factor);
     }
 
     curve = new QCPCurve(xAxis, yAxis);
@@ -210,7 +163,6 @@ void WindPlot::updatePlot()
     QCPItemText *textLabel = new QCPItemText(this);
     addItem(textLabel);
 
-    const double factor = (mMainWindow->units() == PlotValue::Metric) ? MPS_TO_KMH : MPS_TO_MPH;
     const QString units = (mMainWindow->units() == PlotValue::Metric) ? "km/h" : "mph";
 
     double direction = atan2(-mWindE, -mWindN) / M_PI * 180.0;
@@ -241,6 +193,29 @@ void WindPlot::updatePlot()
     replot();
 }
 
+void WindPlot::updateCursor()
+{
+    // The mark is drawn over the plot when it is painted
+    update();
+}
+
+void WindPlot::paintEvent(
+        QPaintEvent *event)
+{
+    QCustomPlot::paintEvent(event);
+
+    if (mMainWindow->markActive())
+    {
+        const DataPoint dpEnd = mMainWindow->markPoint();
+        const double factor = PlotValue::speedFactor(mMainWindow->units());
+
+        QPainter painter(this);
+        drawCursor(&painter, xAxis, yAxis,
+                   dpEnd.velE * factor, dpEnd.velN * factor,
+                   mMainWindow->lineThickness());
+    }
+}
+
 void WindPlot::setViewRange(
         double xMin,
         double xMax,
@@ -282,15 +257,17 @@ void WindPlot::updateWind(
     // Weighted least-squares circle fit based on this:
     //   http://www.dtcenter.org/met/users/docs/write_ups/circle_fit.pdf
 
+    const TrackStore &track = mMainWindow->track();
+    const TrackStore::Span spanVelE = track.column(TrackStore::VelE);
+    const TrackStore::Span spanVelN = track.column(TrackStore::VelN);
+
     double xbar = 0, ybar = 0, N = 0;
     for (int i = start; i < end; ++i)
     {
-        const DataPoint &dp = mMainWindow->dataPoint(i);
-
         const double wi = 1.0;
 
-        const double xi = dp.velE;
-        const double yi = dp.velN;
+        const double xi = spanVelE[i];
+        const double yi = spanVelN[i];
 
         xbar += wi * xi;
         ybar += wi * yi;
@@ -305,12 +282,10 @@ void WindPlot::updateWind(
     double suuu = 0, suvv = 0, svuu = 0, svvv = 0;
     for (int i = start; i < end; ++i)
     {
-        const DataPoint &dp = mMainWindow->dataPoint(i);
-
         const double wi = 1.0;
 
-        const double xi = dp.velE;
-        const double yi = dp.velN;
+        const double xi = spanVelE[i];
+        const double yi = spanVelN[i];
 
         const double ui = xi - xbar;
         const double vi = yi - ybar;
@@ -19,6 +19,8 @@ public:
 protected:
     void mouseMoveEvent(QMouseEvent *event);
 
+    void paintEvent(QPaintEvent *event);
+
 private:
     MainWindow *mMainWindow;
 
@@ -32,6 +34,7 @@ private:
 
 public slots:
     void updatePlot();
+    void updateCursor();
     void save();
 };
 
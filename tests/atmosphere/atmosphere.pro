@@ -0,0 +1,21 @@
+#-------------------------------------------------
+#
+# FlySight Viewer unit tests for Atmosphere
+#
+#-------------------------------------------------
+
+TARGET = tst_atmosphere
+TEMPLATE = app
+
+QT       += testlib
+QT       -= gui
+
+CONFIG   += console testcase
+CONFIG   -= app_bundle
+
+INCLUDEPATH += ../../src
+
+SOURCES += tst_atmosphere.cpp \
+    ../../src/atmosphere.cpp
+
+HEADERS += ../../src/atmosphere.h
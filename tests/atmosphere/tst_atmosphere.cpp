@@ -0,0 +1,132 @@
+#include <QtTest>
+
+#include <math.h>
+
+#include "atmosphere.h"
+#include "common.h"
+
+// Checks the fitted density against the International Standard Atmosphere
+// formula, written out again here so the test does not depend on the code
+// it checks.
+
+class TestAtmosphere : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void exactDensity();
+    void densityInRange();
+    void densityAtEdges();
+    void densityOutsideRange();
+    void batchDensity();
+
+private:
+    static double isaDensity(double hMSL);
+    static double relativeError(double value, double exact);
+};
+
+double TestAtmosphere::isaDensity(
+        double hMSL)
+{
+    const double temperature = SL_TEMP - LAPSE_RATE * hMSL;
+    const double exponent = A_GRAVITY * MM_AIR / GAS_CONST / LAPSE_RATE;
+    const double pressure = SL_PRESSURE * pow(temperature / SL_TEMP, exponent);
+
+    return pressure * MM_AIR / GAS_CONST / temperature;
+}
+
+double TestAtmosphere::relativeError(
+        double value,
+        double exact)
+{
+    return fabs(value - exact) / exact;
+}
+
+void TestAtmosphere::exactDensity()
+{
+    // Standard sea level density
+    QVERIFY(fabs(Atmosphere::exactDensity(0) - 1.225) < 1e-3);
+
+    for (double h = -2000; h <= 20000; h += 500)
+    {
+        QVERIFY(relativeError(Atmosphere::exactDensity(h), isaDensity(h)) < 1e-14);
+    }
+}
+
+void TestAtmosphere::densityInRange()
+{
+    double maxError = 0;
+
+    for (double h = Atmosphere::MinAltitude; h <= Atmosphere::MaxAltitude; h += 0.5)
+    {
+        maxError = qMax(maxError, relativeError(Atmosphere::density(h), isaDensity(h)));
+    }
+
+    QVERIFY2(maxError <= Atmosphere::MaxError,
+             qPrintable(QString("largest relative error %1").arg(maxError)));
+}
+
+void TestAtmosphere::densityAtEdges()
+{
+    const double edges[] = {
+        Atmosphere::MinAltitude,
+        nextafter(Atmosphere::MinAltitude, 0),
+        nextafter(Atmosphere::MaxAltitude, 0),
+        Atmosphere::MaxAltitude
+    };
+
+    for (unsigned i = 0; i < sizeof(edges) / sizeof(edges[0]); ++i)
+    {
+        const double h = edges[i];
+        QVERIFY2(relativeError(Atmosphere::density(h), isaDensity(h)) <= Atmosphere::MaxError,
+                 qPrintable(QString("altitude %1").arg(h, 0, 'g', 17)));
+    }
+}
+
+void TestAtmosphere::densityOutsideRange()
+{
+    // Altitudes outside the fit use the exact formula
+    const double below = nextafter(Atmosphere::MinAltitude, -HUGE_VAL);
+    const double above = nextafter(Atmosphere::MaxAltitude, HUGE_VAL);
+
+    QCOMPARE(Atmosphere::density(below), Atmosphere::exactDensity(below));
+    QCOMPARE(Atmosphere::density(above), Atmosphere::exactDensity(above));
+    QCOMPARE(Atmosphere::density(-5000.0), Atmosphere::exactDensity(-5000));
+    QCOMPARE(Atmosphere::density(30000.0), Atmosphere::exactDensity(30000));
+}
+
+void TestAtmosphere::batchDensity()
+{
+    QVector< double > hMSL, result;
+
+    for (double h = Atmosphere::MinAltitude; h <= Atmosphere::MaxAltitude; h += 7.25)
+    {
+        hMSL.append(h);
+    }
+
+    hMSL.append(Atmosphere::MaxAltitude);
+    result.resize(hMSL.size());
+
+    Atmosphere::density(hMSL.constData(), result.data(), hMSL.size());
+
+    // Same polynomial as single altitudes
+    for (int i = 0; i < hMSL.size(); ++i)
+    {
+        QCOMPARE(result[i], Atmosphere::density(hMSL[i]));
+    }
+
+    // Altitudes outside the fit use the exact formula
+    const double outside[] = { Atmosphere::MinAltitude - 100, Atmosphere::MaxAltitude + 100 };
+    double exact[2];
+
+    Atmosphere::density(outside, exact, 2);
+
+    for (int k = 0; k < 2; ++k)
+    {
+        QCOMPARE(exact[k], Atmosphere::exactDensity(outside[k]));
+    }
+}
+
+QTEST_APPLESS_MAIN(TestAtmosphere)
+
+#include "tst_atmosphere.moc"
@@ -0,0 +1,9 @@
+#-------------------------------------------------
+#
+# FlySight Viewer unit tests, run with "make check"
+#
+#-------------------------------------------------
+
+TEMPLATE = subdirs
+
+SUBDIRS += atmosphere